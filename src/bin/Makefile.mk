@@ -1,8 +1,20 @@
 
 bin_PROGRAMS = \
+src/bin/ender-compile \
 src/bin/ender-inspect \
 src/bin/ender-loader
 
+src_bin_ender_compile_LDADD = \
+$(top_builddir)/src/lib/libender.la \
+@ENDER_LIBS@
+
+src_bin_ender_compile_CPPFLAGS = \
+-I$(top_srcdir)/src/lib \
+@ENDER_CFLAGS@
+
+src_bin_ender_compile_SOURCES = \
+src/bin/ender_compile.c
+
 src_bin_ender_inspect_LDADD = \
 $(top_builddir)/src/lib/libender.la \
 @ENDER_LIBS@
@@ -0,0 +1,219 @@
+/* ENDER - Enesim's descriptor library
+ * Copyright (C) 2010 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Ender.h"
+
+#include <ctype.h>
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+static void help(void)
+{
+	printf("Run: ender_compile [--no-symbols] FILE.ender OUTPUT.c\n");
+	printf("Generates the C source of the precompiled lib described on\n");
+	printf("FILE.ender. The generated source exports the function\n");
+	printf("Eina_Bool NAME_ender_register(void)\n");
+	printf("which adds the lib once ender is initialized. By default the\n");
+	printf("source refers to the symbols of the lib, so the program must be\n");
+	printf("linked with it. With --no-symbols the lib is loaded on demand\n");
+}
+
+/* The name of the lib as a C identifier */
+static char * lib_id_get(const char *name)
+{
+	char *id;
+	char *c;
+
+	id = strdup(name);
+	for (c = id; *c; c++)
+	{
+		if (!isalnum((unsigned char)*c))
+			*c = '_';
+	}
+	return id;
+}
+
+static int symbol_cmp(const void *d1, const void *d2)
+{
+	return strcmp(d1, d2);
+}
+
+static void image_dump(FILE *f, const void *image, size_t size)
+{
+	const unsigned char *bytes = image;
+	size_t i;
+
+	/* as bytes, in the same order whatever the host, the union aligns
+	 * them to 64 bits
+	 */
+	fprintf(f, "static const union\n{\n");
+	fprintf(f, "\tuint64_t align;\n");
+	fprintf(f, "\tunsigned char data[%lu];\n", (unsigned long)size);
+	fprintf(f, "} _image = { .data = {\n");
+	for (i = 0; i < size; i++)
+	{
+		fprintf(f, "%s0x%02x,%s", i % 12 ? " " : "\t", bytes[i],
+				i % 12 == 11 ? "\n" : "");
+	}
+	if (size % 12)
+		fprintf(f, "\n");
+	fprintf(f, "} };\n\n");
+}
+
+static void symbols_dump(FILE *f, Eina_List *symbols)
+{
+	Eina_List *l;
+	char *sym;
+	int n = 0;
+
+	/* only the addresses are used, the symbols are declared with another
+	 * name so they do not conflict with the prototypes already visible,
+	 * like the ones of Ender.h or the builtins
+	 */
+	fprintf(f, "#define _ENDER_SYM_STR(s) _ENDER_SYM_STR2(s)\n");
+	fprintf(f, "#define _ENDER_SYM_STR2(s) #s\n");
+	fprintf(f, "#define _ENDER_SYM(s) "
+			"__asm__(_ENDER_SYM_STR(__USER_LABEL_PREFIX__) s)\n\n");
+	EINA_LIST_FOREACH(symbols, l, sym)
+		fprintf(f, "extern void _ender_sym_%d(void) _ENDER_SYM(\"%s\");\n",
+				n++, sym);
+	fprintf(f, "\nstatic const Ender_Lib_Image_Symbol _symbols[] = {\n");
+	n = 0;
+	EINA_LIST_FOREACH(symbols, l, sym)
+		fprintf(f, "\t{ \"%s\", (void *)_ender_sym_%d },\n", sym, n++);
+	fprintf(f, "};\n\n");
+}
+
+static Eina_Bool lib_compile(const Ender_Lib *lib, const char *src,
+		const char *file, Eina_Bool with_symbols)
+{
+	Eina_List *symbols = NULL;
+	Eina_List *l;
+	char *sym;
+	char *prev = NULL;
+	char *id;
+	void *image;
+	size_t size;
+	FILE *f;
+
+	image = ender_lib_image_new(lib, &size);
+	if (!image)
+	{
+		printf("Impossible to create the image of '%s'\n",
+				ender_lib_name_get(lib));
+		return EINA_FALSE;
+	}
+	f = fopen(file, "w");
+	if (!f)
+	{
+		printf("Impossible to open '%s'\n", file);
+		free(image);
+		return EINA_FALSE;
+	}
+
+	if (with_symbols)
+	{
+		/* the getters and setters might share the symbols */
+		symbols = eina_list_sort(ender_lib_symbols_get(lib), -1, symbol_cmp);
+		for (l = symbols; l; )
+		{
+			Eina_List *next = eina_list_next(l);
+
+			sym = eina_list_data_get(l);
+			if (prev && !strcmp(prev, sym))
+			{
+				symbols = eina_list_remove_list(symbols, l);
+				free(sym);
+			}
+			else
+			{
+				prev = sym;
+			}
+			l = next;
+		}
+	}
+
+	id = lib_id_get(ender_lib_name_get(lib));
+	fprintf(f, "/* Generated by ender-compile from %s, do not edit */\n", src);
+	fprintf(f, "#include <Ender.h>\n\n");
+	image_dump(f, image, size);
+	if (symbols)
+		symbols_dump(f, symbols);
+	fprintf(f, "static const Ender_Lib_Image _lib = {\n");
+	fprintf(f, "\t_image.data, %lu, %s, %u\n", (unsigned long)size,
+			symbols ? "_symbols" : "NULL", eina_list_count(symbols));
+	fprintf(f, "};\n\n");
+	fprintf(f, "Eina_Bool %s_ender_register(void);\n\n", id);
+	fprintf(f, "Eina_Bool %s_ender_register(void)\n", id);
+	fprintf(f, "{\n\treturn ender_lib_image_add(&_lib);\n}\n");
+
+	EINA_LIST_FREE(symbols, sym)
+		free(sym);
+	free(id);
+	free(image);
+	if (fclose(f))
+	{
+		printf("Impossible to write '%s'\n", file);
+		return EINA_FALSE;
+	}
+	return EINA_TRUE;
+}
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+int main(int argc, char **argv)
+{
+	const Ender_Lib *lib;
+	Eina_Bool with_symbols = EINA_TRUE;
+	FILE *f;
+	int ret = -1;
+
+	if (argc > 1 && !strcmp(argv[1], "--no-symbols"))
+	{
+		with_symbols = EINA_FALSE;
+		argc--;
+		argv++;
+	}
+	if (argc < 3)
+	{
+		help();
+		return -1;
+	}
+
+	/* only the included libs are loaded from the descriptions dir */
+	unsetenv("ENDER_EAGER_LOAD");
+	unsetenv("ENDER_SYMBOLS_RESOLVE");
+	ender_init();
+	f = fopen(argv[1], "r");
+	if (!f)
+	{
+		printf("Impossible to open '%s'\n", argv[1]);
+		goto done;
+	}
+	/* the lib is named as the description says, not as the file */
+	lib = ender_parser_parse_lib(f);
+	fclose(f);
+
+	if (!lib)
+		printf("No lib described on '%s'\n", argv[1]);
+	else if (lib_compile(lib, argv[1], argv[2], with_symbols))
+		ret = 0;
+done:
+	ender_shutdown();
+	return ret;
+}
@@ -15,11 +15,28 @@
  * License along with this library.
  * If not, see <http://www.gnu.org/licenses/>.
  */
+/* for RTLD_DEFAULT */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include "Ender.h"
 
+#include <dlfcn.h>
+
+/* The function a profile driver must export */
+#define DRIVER_SYMBOL "ender_inspect_driver"
+typedef int (*Driver)(const Ender_Lib *lib, int argc, char **argv);
+
 static void help(void)
 {
 	printf("Run: ender_inspect NAME\n");
+	printf("     ender_inspect --profile NAME [DRIVER [ARGS]]\n");
+	printf("The DRIVER is a shared object that exports the function\n");
+	printf("int " DRIVER_SYMBOL "(const Ender_Lib *lib, int argc, char **argv)\n");
+	printf("which is called with the lib and the ARGS. In case no DRIVER\n");
+	printf("is given, the function is looked up on the already loaded\n");
+	printf("objects, for example through LD_PRELOAD\n");
 }
 
 static const char * value_type_dump(Ender_Value_Type vtype)
@@ -238,11 +255,57 @@ static void lib_dump(const Ender_Lib *l)
 	}
 }
 
+static int lib_profile(const Ender_Lib *l, const char *file, int argc,
+		char **argv)
+{
+	Driver driver;
+	void *dl = NULL;
+	int ret;
+
+	if (file)
+	{
+		dl = dlopen(file, RTLD_NOW | RTLD_GLOBAL);
+		if (!dl)
+		{
+			printf("Impossible to load the driver '%s': %s\n", file,
+					dlerror());
+			return -1;
+		}
+		driver = (Driver)dlsym(dl, DRIVER_SYMBOL);
+	}
+	else
+	{
+		driver = (Driver)dlsym(RTLD_DEFAULT, DRIVER_SYMBOL);
+	}
+	if (!driver)
+	{
+		printf("No '" DRIVER_SYMBOL "' function found\n");
+		if (dl)
+			dlclose(dl);
+		return -1;
+	}
+
+	ender_profile_enable(EINA_TRUE);
+	ret = driver(l, argc, argv);
+	ender_profile_enable(EINA_FALSE);
+	ender_lib_profile_dump(l);
+	/* the driver is not closed, the objects it created might still be in use */
+	return ret;
+}
+
 int main(int argc, char **argv)
 {
 	const Ender_Lib *lib;
+	Eina_Bool profile = EINA_FALSE;
+	int ret = 0;
 
 	ender_init();
+	if (argc > 1 && !strcmp(argv[1], "--profile"))
+	{
+		profile = EINA_TRUE;
+		argc--;
+		argv++;
+	}
 	if (argc < 2)
 	{
 		help();
@@ -253,11 +316,16 @@ int main(int argc, char **argv)
 	{
 		printf("No such lib '%s'\n", argv[1]);
 	}
+	else if (profile)
+	{
+		ret = lib_profile(lib, argc > 2 ? argv[2] : NULL,
+				argc > 3 ? argc - 3 : 0, argv + 3);
+	}
 	else
 	{
 		lib_dump(lib);
 	}
 	ender_shutdown();
 
-	return 0;
+	return ret;
 }
@@ -22,6 +22,12 @@ src/lib/ender_utils.h \
 src/lib/ender_value.h
 
 src_lib_libender_la_SOURCES = \
+src/lib/ender_cache.c \
+src/lib/ender_cache_private.h \
+src/lib/ender_call_jit.c \
+src/lib/ender_call_jit_private.h \
+src/lib/ender_call_thunk.c \
+src/lib/ender_call_thunk_private.h \
 src/lib/ender_item.c \
 src/lib/ender_item_private.h \
 src/lib/ender_item_arg.c \
@@ -47,6 +53,7 @@ src/lib/ender_lib_private.h \
 src/lib/ender_main.c \
 src/lib/ender_main_private.h \
 src/lib/ender_parser.c \
+src/lib/ender_parser_private.h \
 src/lib/ender_private.h \
 src/lib/ender_utils.c \
 src/lib/ender_value.c \
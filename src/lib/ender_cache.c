@@ -0,0 +1,1707 @@
+/* ENDER - Enesim's descriptor library
+ * Copyright (C) 2010 - 2012 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ender_private.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "ender_main.h"
+#include "ender_value.h"
+#include "ender_item.h"
+#include "ender_item_arg.h"
+#include "ender_item_attr.h"
+#include "ender_item_constant.h"
+#include "ender_item_def.h"
+#include "ender_item_enum.h"
+#include "ender_item_function.h"
+#include "ender_item_object.h"
+#include "ender_item_struct.h"
+#include "ender_lib.h"
+
+#include "ender_main_private.h"
+#include "ender_item_private.h"
+#include "ender_item_arg_private.h"
+#include "ender_item_attr_private.h"
+#include "ender_item_constant_private.h"
+#include "ender_item_def_private.h"
+#include "ender_item_enum_private.h"
+#include "ender_item_function_private.h"
+#include "ender_item_object_private.h"
+#include "ender_item_struct_private.h"
+#include "ender_lib_private.h"
+#include "ender_cache_private.h"
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+/* A cache file is the flat representation of a registered lib, it has no
+ * pointers so it can be mapped and read directly. The file is composed of the
+ * header followed by the items, the links, the externals and the strings.
+ * The items refer to other items by their index on the items table, the
+ * lists of items are ranges on the links table. An item of another lib is
+ * an external, referred by name, with the ENDER_CACHE_EXTERNAL bit set on the
+ * index. The items are stored children first, so they can be linked in order.
+ * The offsets of the fields depend on the types of the included libs, so the
+ * hash of every included lib is stored too and the cache is outdated once
+ * any of them changes. The same image is compiled into programs by ender-compile
+ */
+#define ENDER_CACHE_MAGIC "ENDERC"
+#define ENDER_CACHE_VERSION 2
+#define ENDER_CACHE_NONE 0xffffffff
+#define ENDER_CACHE_EXTERNAL 0x80000000
+
+typedef struct _Ender_Cache_Header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t size;
+	/* the source description */
+	int64_t mtime;
+	int64_t source_size;
+	uint32_t hash;
+	/* the lib */
+	uint32_t name;
+	int32_t lib_version;
+	uint32_t kase;
+	uint32_t notation;
+	uint32_t deps;
+	uint32_t ndeps;
+	/* the hash of every dep, on the links table too */
+	uint32_t dep_hashes;
+	uint32_t exported;
+	uint32_t nexported;
+	/* the tables */
+	uint32_t items;
+	uint32_t nitems;
+	uint32_t links;
+	uint32_t nlinks;
+	uint32_t externals;
+	uint32_t nexternals;
+	uint32_t strings;
+	uint32_t nstrings;
+} Ender_Cache_Header;
+
+typedef struct _Ender_Cache_Item
+{
+	uint32_t type;
+	uint32_t name;
+	uint32_t symname;
+	int32_t flags;
+	/* the type of an arg, attr, def or constant, the inherit of an object
+	 * and the return of a function
+	 */
+	uint32_t ref;
+	/* the getter and setter of an attr */
+	uint32_t getter;
+	uint32_t setter;
+	/* the direction and transfer of an arg */
+	uint32_t direction;
+	uint32_t transfer;
+	/* the args, fields, props or values */
+	uint32_t children;
+	uint32_t nchildren;
+	uint32_t functions;
+	uint32_t nfunctions;
+	uint32_t pad;
+	/* the offset of an attr, the size of a struct or the value of a
+	 * constant
+	 */
+	int64_t value;
+} Ender_Cache_Item;
+
+typedef struct _Ender_Cache_Writer
+{
+	const Ender_Lib *lib;
+	/* the index + 1 of every item */
+	Eina_Hash *indexes;
+	Eina_Hash *externals;
+	Ender_Item **order;
+	unsigned int norder;
+	unsigned int aorder;
+	uint32_t *links;
+	unsigned int nlinks;
+	unsigned int alinks;
+	uint32_t *ext;
+	unsigned int next;
+	unsigned int aext;
+	/* the offset + 1 of every string */
+	Eina_Hash *offsets;
+	char *strings;
+	unsigned int nstrings;
+	unsigned int astrings;
+} Ender_Cache_Writer;
+
+static char *_dir = NULL;
+
+static void * _ender_cache_grow(void *data, unsigned int *alloc,
+		unsigned int needed, size_t size)
+{
+	if (needed <= *alloc)
+		return data;
+	while (*alloc < needed)
+		*alloc = *alloc ? *alloc * 2 : 64;
+	return realloc(data, *alloc * size);
+}
+
+static Eina_Bool _ender_cache_source_get(const char *source, int64_t *mtime,
+		int64_t *size, uint32_t *hash)
+{
+	struct stat st;
+	void *content;
+	int fd;
+
+	fd = open(source, O_RDONLY);
+	if (fd < 0)
+		return EINA_FALSE;
+	if (fstat(fd, &st) < 0)
+	{
+		close(fd);
+		return EINA_FALSE;
+	}
+	*mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+	*size = st.st_size;
+	if (!hash || !st.st_size)
+	{
+		if (hash) *hash = 0;
+		close(fd);
+		return EINA_TRUE;
+	}
+
+	content = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (content == MAP_FAILED)
+		return EINA_FALSE;
+	*hash = eina_hash_superfast(content, st.st_size);
+	munmap(content, st.st_size);
+	return EINA_TRUE;
+}
+
+static char * _ender_cache_file_get(const char *name)
+{
+	char *file = NULL;
+
+	if (!_dir)
+		return NULL;
+	if (asprintf(&file, "%s/%s.enderc", _dir, name) < 0)
+		return NULL;
+	return file;
+}
+/*----------------------------------------------------------------------------*
+ *                                 writer                                     *
+ *----------------------------------------------------------------------------*/
+static uint32_t _ender_cache_writer_string(Ender_Cache_Writer *w,
+		const char *str)
+{
+	uintptr_t offset;
+	unsigned int len;
+
+	if (!str)
+		return ENDER_CACHE_NONE;
+	offset = (uintptr_t)eina_hash_find(w->offsets, str);
+	if (offset)
+		return offset - 1;
+
+	len = strlen(str) + 1;
+	offset = w->nstrings;
+	w->strings = _ender_cache_grow(w->strings, &w->astrings,
+			w->nstrings + len, 1);
+	memcpy(w->strings + w->nstrings, str, len);
+	w->nstrings += len;
+	eina_hash_add(w->offsets, str, (void *)(offset + 1));
+	return offset;
+}
+
+/* The self arg of the methods and the return of the ctors are created on
+ * demand from the parent, they are not part of the description
+ */
+static Eina_List * _ender_cache_writer_args_get(Ender_Item *i)
+{
+	Eina_List *args;
+
+	args = ender_item_function_args_get(i);
+	if (ender_item_function_flags_get(i) & ENDER_ITEM_FUNCTION_FLAG_IS_METHOD)
+	{
+		ender_item_unref(eina_list_data_get(args));
+		args = eina_list_remove_list(args, args);
+	}
+	return args;
+}
+
+static Ender_Item * _ender_cache_writer_ret_get(Ender_Item *i)
+{
+	if (ender_item_function_flags_get(i) & ENDER_ITEM_FUNCTION_FLAG_CTOR)
+		return NULL;
+	return ender_item_function_ret_get(i);
+}
+
+static uint32_t _ender_cache_writer_links(Ender_Cache_Writer *w,
+		Eina_List *items, uint32_t *count);
+
+static uint32_t _ender_cache_writer_index(Ender_Cache_Writer *w,
+		Ender_Item *i);
+
+/* Assign the indexes of the children before the index of the item */
+static void _ender_cache_writer_children_index(Ender_Cache_Writer *w,
+		Eina_List *items)
+{
+	Ender_Item *i;
+
+	EINA_LIST_FREE(items, i)
+	{
+		_ender_cache_writer_index(w, i);
+		ender_item_unref(i);
+	}
+}
+
+static uint32_t _ender_cache_writer_index(Ender_Cache_Writer *w,
+		Ender_Item *i)
+{
+	uintptr_t idx;
+
+	if (!i)
+		return ENDER_CACHE_NONE;
+	idx = (uintptr_t)eina_hash_find(w->indexes, &i);
+	if (idx)
+		return idx - 1;
+
+	switch (ender_item_type_get(i))
+	{
+		case ENDER_ITEM_TYPE_FUNCTION:
+		_ender_cache_writer_children_index(w,
+				_ender_cache_writer_args_get(i));
+		_ender_cache_writer_children_index(w, eina_list_append(NULL,
+				_ender_cache_writer_ret_get(i)));
+		break;
+
+		case ENDER_ITEM_TYPE_ATTR:
+		_ender_cache_writer_children_index(w, eina_list_append(
+				eina_list_append(NULL, ender_item_attr_getter_get(i)),
+				ender_item_attr_setter_get(i)));
+		break;
+
+		case ENDER_ITEM_TYPE_STRUCT:
+		_ender_cache_writer_children_index(w,
+				ender_item_struct_fields_get(i));
+		_ender_cache_writer_children_index(w,
+				ender_item_struct_functions_get(i));
+		break;
+
+		case ENDER_ITEM_TYPE_OBJECT:
+		_ender_cache_writer_children_index(w,
+				ender_item_object_props_get(i));
+		_ender_cache_writer_children_index(w,
+				ender_item_object_functions_get(i));
+		break;
+
+		case ENDER_ITEM_TYPE_DEF:
+		_ender_cache_writer_children_index(w,
+				ender_item_def_functions_get(i));
+		break;
+
+		case ENDER_ITEM_TYPE_ENUM:
+		_ender_cache_writer_children_index(w,
+				ender_item_enum_values_get(i));
+		break;
+
+		default:
+		break;
+	}
+
+	idx = w->norder;
+	w->order = _ender_cache_grow(w->order, &w->aorder, w->norder + 1,
+			sizeof(Ender_Item *));
+	w->order[w->norder++] = i;
+	eina_hash_add(w->indexes, &i, (void *)(idx + 1));
+	return idx;
+}
+
+/* A reference to an item that might belong to another lib */
+static uint32_t _ender_cache_writer_ref(Ender_Cache_Writer *w, Ender_Item *i)
+{
+	uintptr_t idx;
+
+	if (!i)
+		return ENDER_CACHE_NONE;
+	if (!i->lib || i->lib == w->lib)
+		return _ender_cache_writer_index(w, i);
+
+	idx = (uintptr_t)eina_hash_find(w->externals, &i);
+	if (idx)
+		return (idx - 1) | ENDER_CACHE_EXTERNAL;
+
+	idx = w->next;
+	w->ext = _ender_cache_grow(w->ext, &w->aext, w->next + 1,
+			sizeof(uint32_t));
+	w->ext[w->next++] = _ender_cache_writer_string(w,
+			ender_item_name_get(i));
+	eina_hash_add(w->externals, &i, (void *)(idx + 1));
+	return idx | ENDER_CACHE_EXTERNAL;
+}
+
+static uint32_t _ender_cache_writer_links(Ender_Cache_Writer *w,
+		Eina_List *items, uint32_t *count)
+{
+	Ender_Item *i;
+	uint32_t start;
+
+	start = w->nlinks;
+	*count = eina_list_count(items);
+	w->links = _ender_cache_grow(w->links, &w->alinks, w->nlinks + *count,
+			sizeof(uint32_t));
+	EINA_LIST_FREE(items, i)
+	{
+		w->links[w->nlinks++] = _ender_cache_writer_index(w, i);
+		ender_item_unref(i);
+	}
+	return start;
+}
+
+static void _ender_cache_writer_item(Ender_Cache_Writer *w, Ender_Item *i,
+		Ender_Cache_Item *r)
+{
+	Ender_Item *other;
+	Ender_Value v;
+
+	memset(r, 0, sizeof(Ender_Cache_Item));
+	r->type = ender_item_type_get(i);
+	r->name = _ender_cache_writer_string(w, ender_item_name_get(i));
+	r->symname = ENDER_CACHE_NONE;
+	r->ref = ENDER_CACHE_NONE;
+	r->getter = ENDER_CACHE_NONE;
+	r->setter = ENDER_CACHE_NONE;
+
+	switch (r->type)
+	{
+		case ENDER_ITEM_TYPE_FUNCTION:
+		r->symname = _ender_cache_writer_string(w,
+				ender_item_function_symname_get(i));
+		r->flags = ender_item_function_flags_get(i);
+		other = _ender_cache_writer_ret_get(i);
+		r->ref = _ender_cache_writer_index(w, other);
+		ender_item_unref(other);
+		r->children = _ender_cache_writer_links(w,
+				_ender_cache_writer_args_get(i), &r->nchildren);
+		break;
+
+		case ENDER_ITEM_TYPE_ARG:
+		r->flags = ender_item_arg_flags_get(i);
+		r->direction = ender_item_arg_direction_get(i);
+		r->transfer = ender_item_arg_transfer_get(i);
+		other = ender_item_arg_type_get(i);
+		r->ref = _ender_cache_writer_ref(w, other);
+		ender_item_unref(other);
+		break;
+
+		case ENDER_ITEM_TYPE_ATTR:
+		r->flags = ender_item_attr_flags_get(i);
+		r->value = ender_item_attr_offset_get(i);
+		other = ender_item_attr_type_get(i);
+		r->ref = _ender_cache_writer_ref(w, other);
+		ender_item_unref(other);
+		other = ender_item_attr_getter_get(i);
+		r->getter = _ender_cache_writer_index(w, other);
+		ender_item_unref(other);
+		other = ender_item_attr_setter_get(i);
+		r->setter = _ender_cache_writer_index(w, other);
+		ender_item_unref(other);
+		break;
+
+		case ENDER_ITEM_TYPE_STRUCT:
+		r->value = ender_item_struct_size_get(i);
+		r->children = _ender_cache_writer_links(w,
+				ender_item_struct_fields_get(i), &r->nchildren);
+		r->functions = _ender_cache_writer_links(w,
+				ender_item_struct_functions_get(i), &r->nfunctions);
+		break;
+
+		case ENDER_ITEM_TYPE_OBJECT:
+		other = ender_item_object_inherit_get(i);
+		r->ref = _ender_cache_writer_ref(w, other);
+		ender_item_unref(other);
+		r->children = _ender_cache_writer_links(w,
+				ender_item_object_props_get(i), &r->nchildren);
+		r->functions = _ender_cache_writer_links(w,
+				ender_item_object_functions_get(i), &r->nfunctions);
+		break;
+
+		case ENDER_ITEM_TYPE_DEF:
+		other = ender_item_def_type_get(i);
+		r->ref = _ender_cache_writer_ref(w, other);
+		ender_item_unref(other);
+		r->functions = _ender_cache_writer_links(w,
+				ender_item_def_functions_get(i), &r->nfunctions);
+		break;
+
+		case ENDER_ITEM_TYPE_ENUM:
+		r->children = _ender_cache_writer_links(w,
+				ender_item_enum_values_get(i), &r->nchildren);
+		break;
+
+		case ENDER_ITEM_TYPE_CONSTANT:
+		other = ender_item_constant_type_get(i);
+		r->ref = _ender_cache_writer_ref(w, other);
+		ender_item_unref(other);
+		ender_item_constant_value_get(i, &v);
+		memcpy(&r->value, &v, sizeof(int64_t));
+		break;
+
+		default:
+		break;
+	}
+}
+
+/* Put every table together after the header */
+static void * _ender_cache_writer_image(Ender_Cache_Writer *w,
+		Ender_Cache_Header *h, Ender_Cache_Item *items)
+{
+	char *image;
+
+	image = malloc(h->size);
+	if (!image)
+		return NULL;
+	memcpy(image, h, sizeof(Ender_Cache_Header));
+	if (h->nitems)
+		memcpy(image + h->items, items, h->nitems * sizeof(Ender_Cache_Item));
+	if (h->nlinks)
+		memcpy(image + h->links, w->links, h->nlinks * sizeof(uint32_t));
+	if (h->nexternals)
+		memcpy(image + h->externals, w->ext, h->nexternals * sizeof(uint32_t));
+	memcpy(image + h->strings, w->strings, h->nstrings);
+	return image;
+}
+
+static Eina_Bool _ender_cache_write(const void *image, size_t size,
+		const char *file)
+{
+	char *tmp = NULL;
+	Eina_Bool ret = EINA_FALSE;
+	FILE *f;
+
+	/* write on a temporary file and rename it, this way other processes
+	 * never see a partial file
+	 */
+	if (asprintf(&tmp, "%s.%d", file, (int)getpid()) < 0)
+		return EINA_FALSE;
+	f = fopen(tmp, "wb");
+	if (!f)
+	{
+		free(tmp);
+		return EINA_FALSE;
+	}
+	if (fwrite(image, 1, size, f) == size)
+		ret = EINA_TRUE;
+	if (fclose(f))
+		ret = EINA_FALSE;
+	if (ret && rename(tmp, file) < 0)
+		ret = EINA_FALSE;
+	if (!ret)
+		unlink(tmp);
+	free(tmp);
+	return ret;
+}
+/*----------------------------------------------------------------------------*
+ *                                 reader                                     *
+ *----------------------------------------------------------------------------*/
+static Eina_Bool _ender_cache_range_check(const Ender_Cache_Header *h,
+		uint32_t offset, uint32_t count, size_t size)
+{
+	if (offset > h->size)
+		return EINA_FALSE;
+	if (count > (h->size - offset) / size)
+		return EINA_FALSE;
+	return EINA_TRUE;
+}
+
+static const char * _ender_cache_string(const Ender_Cache_Header *h,
+		uint32_t offset)
+{
+	if (offset == ENDER_CACHE_NONE)
+		return NULL;
+	return (const char *)h + h->strings + offset;
+}
+
+static Eina_Bool _ender_cache_header_check(const Ender_Cache_Header *h,
+		size_t size)
+{
+	const char *strings;
+
+	if (size < sizeof(Ender_Cache_Header))
+		return EINA_FALSE;
+	if (memcmp(h->magic, ENDER_CACHE_MAGIC, sizeof(ENDER_CACHE_MAGIC)))
+		return EINA_FALSE;
+	if (h->version != ENDER_CACHE_VERSION)
+		return EINA_FALSE;
+	if (h->size != size)
+		return EINA_FALSE;
+	if (!_ender_cache_range_check(h, h->items, h->nitems, sizeof(Ender_Cache_Item)))
+		return EINA_FALSE;
+	if (!_ender_cache_range_check(h, h->links, h->nlinks, sizeof(uint32_t)))
+		return EINA_FALSE;
+	if (!_ender_cache_range_check(h, h->externals, h->nexternals, sizeof(uint32_t)))
+		return EINA_FALSE;
+	if (!_ender_cache_range_check(h, h->strings, h->nstrings, 1))
+		return EINA_FALSE;
+	if (h->items % sizeof(int64_t))
+		return EINA_FALSE;
+	/* the strings must be terminated */
+	strings = (const char *)h + h->strings;
+	if (!h->nstrings || strings[h->nstrings - 1])
+		return EINA_FALSE;
+	if (h->name >= h->nstrings)
+		return EINA_FALSE;
+	return EINA_TRUE;
+}
+
+/* Check that every index is on the tables, this way the loading does not need
+ * to check anything
+ */
+static Eina_Bool _ender_cache_check(const Ender_Cache_Header *h, size_t size)
+{
+	const uint32_t *links;
+	const uint32_t *ext;
+	const Ender_Cache_Item *items;
+	unsigned int i;
+
+	if (!_ender_cache_header_check(h, size))
+		return EINA_FALSE;
+	/* the ranges on the links table */
+	if (h->deps > h->nlinks || h->ndeps > h->nlinks - h->deps)
+		return EINA_FALSE;
+	if (h->dep_hashes > h->nlinks || h->ndeps > h->nlinks - h->dep_hashes)
+		return EINA_FALSE;
+	if (h->exported > h->nlinks || h->nexported > h->nlinks - h->exported)
+		return EINA_FALSE;
+
+	links = (const uint32_t *)((const char *)h + h->links);
+	for (i = 0; i < h->ndeps; i++)
+	{
+		if (links[h->deps + i] >= h->nstrings)
+			return EINA_FALSE;
+	}
+	for (i = 0; i < h->nexported; i++)
+	{
+		if (links[h->exported + i] >= h->nitems)
+			return EINA_FALSE;
+	}
+	ext = (const uint32_t *)((const char *)h + h->externals);
+	for (i = 0; i < h->nexternals; i++)
+	{
+		if (ext[i] >= h->nstrings)
+			return EINA_FALSE;
+	}
+
+	items = (const Ender_Cache_Item *)((const char *)h + h->items);
+	for (i = 0; i < h->nitems; i++)
+	{
+		const Ender_Cache_Item *r = &items[i];
+		unsigned int j;
+
+		if (r->name != ENDER_CACHE_NONE && r->name >= h->nstrings)
+			return EINA_FALSE;
+		if (r->symname != ENDER_CACHE_NONE && r->symname >= h->nstrings)
+			return EINA_FALSE;
+		if (r->ref != ENDER_CACHE_NONE)
+		{
+			if (r->ref & ENDER_CACHE_EXTERNAL)
+			{
+				if ((r->ref & ~ENDER_CACHE_EXTERNAL) >= h->nexternals)
+					return EINA_FALSE;
+			}
+			else if (r->ref >= h->nitems)
+				return EINA_FALSE;
+		}
+		/* the children are always stored before */
+		if (r->getter != ENDER_CACHE_NONE && r->getter >= i)
+			return EINA_FALSE;
+		if (r->setter != ENDER_CACHE_NONE && r->setter >= i)
+			return EINA_FALSE;
+		if (r->children > h->nlinks || r->nchildren > h->nlinks - r->children)
+			return EINA_FALSE;
+		if (r->functions > h->nlinks || r->nfunctions > h->nlinks - r->functions)
+			return EINA_FALSE;
+		for (j = 0; j < r->nchildren; j++)
+		{
+			if (links[r->children + j] >= i)
+				return EINA_FALSE;
+		}
+		for (j = 0; j < r->nfunctions; j++)
+		{
+			if (links[r->functions + j] >= i)
+				return EINA_FALSE;
+		}
+		/* the fields must be inside the struct, the size of every field
+		 * is checked once its type is found
+		 */
+		if (r->type == ENDER_ITEM_TYPE_STRUCT)
+		{
+			if (r->value < 0)
+				return EINA_FALSE;
+			for (j = 0; j < r->nchildren; j++)
+			{
+				const Ender_Cache_Item *f;
+
+				f = &items[links[r->children + j]];
+				if (f->type != ENDER_ITEM_TYPE_ATTR)
+					return EINA_FALSE;
+				if (f->value < 0 || f->value > r->value)
+					return EINA_FALSE;
+			}
+		}
+	}
+	return EINA_TRUE;
+}
+
+/* Check that every included lib is the same as when the image was created.
+ * The registry must be locked
+ */
+static Eina_Bool _ender_cache_deps_check(const Ender_Cache_Header *h)
+{
+	const uint32_t *links;
+	unsigned int i;
+
+	links = (const uint32_t *)((const char *)h + h->links);
+	for (i = 0; i < h->ndeps; i++)
+	{
+		const Ender_Lib *dep;
+
+		dep = ender_lib_description_load(_ender_cache_string(h,
+				links[h->deps + i]));
+		if (!dep)
+			return EINA_FALSE;
+		if (ender_lib_hash_get(dep) != links[h->dep_hashes + i])
+			return EINA_FALSE;
+	}
+	return EINA_TRUE;
+}
+
+/* Get the size of a field from its type, either a def of the image or an item
+ * of another lib
+ */
+static Eina_Bool _ender_cache_field_size_get(const Ender_Cache_Header *h,
+		const Ender_Cache_Item *records, Ender_Item **externals,
+		uint32_t ref, size_t *size)
+{
+	unsigned int depth;
+
+	/* a def can not refer to itself */
+	for (depth = 0; depth < h->nitems; depth++)
+	{
+		if (ref == ENDER_CACHE_NONE)
+			return EINA_FALSE;
+		if (ref & ENDER_CACHE_EXTERNAL)
+			return ender_item_struct_field_size_get(
+					externals[ref & ~ENDER_CACHE_EXTERNAL], size);
+		if (records[ref].type != ENDER_ITEM_TYPE_DEF)
+			return EINA_FALSE;
+		ref = records[ref].ref;
+	}
+	return EINA_FALSE;
+}
+
+/* Check that every field of every struct fits on the struct */
+static Eina_Bool _ender_cache_layout_check(const Ender_Cache_Header *h,
+		const Ender_Cache_Item *records, Ender_Item **externals,
+		const uint32_t *links)
+{
+	unsigned int i;
+
+	for (i = 0; i < h->nitems; i++)
+	{
+		const Ender_Cache_Item *r = &records[i];
+		unsigned int j;
+
+		if (r->type != ENDER_ITEM_TYPE_STRUCT)
+			continue;
+		for (j = 0; j < r->nchildren; j++)
+		{
+			const Ender_Cache_Item *f;
+			size_t size;
+
+			f = &records[links[r->children + j]];
+			if (!_ender_cache_field_size_get(h, records, externals, f->ref,
+					&size))
+				return EINA_FALSE;
+			if (size > (uint64_t)(r->value - f->value))
+				return EINA_FALSE;
+		}
+	}
+	return EINA_TRUE;
+}
+
+static Ender_Item * _ender_cache_item_new(const Ender_Cache_Header *h,
+		const Ender_Cache_Item *r)
+{
+	Ender_Item *i;
+
+	switch (r->type)
+	{
+		case ENDER_ITEM_TYPE_FUNCTION:
+		i = ender_item_function_new();
+		ender_item_function_flags_set(i, r->flags);
+		if (r->symname != ENDER_CACHE_NONE)
+			ender_item_function_symname_set(i,
+					_ender_cache_string(h, r->symname));
+		break;
+
+		case ENDER_ITEM_TYPE_ARG:
+		i = ender_item_arg_new();
+		ender_item_arg_flags_set(i, r->flags);
+		ender_item_arg_direction_set(i, r->direction);
+		ender_item_arg_transfer_set(i, r->transfer);
+		break;
+
+		case ENDER_ITEM_TYPE_ATTR:
+		i = ender_item_attr_new();
+		ender_item_attr_flags_set(i, r->flags);
+		break;
+
+		case ENDER_ITEM_TYPE_STRUCT:
+		i = ender_item_struct_new();
+		break;
+
+		case ENDER_ITEM_TYPE_OBJECT:
+		i = ender_item_object_new();
+		break;
+
+		case ENDER_ITEM_TYPE_DEF:
+		i = ender_item_def_new();
+		break;
+
+		case ENDER_ITEM_TYPE_ENUM:
+		i = ender_item_enum_new();
+		break;
+
+		case ENDER_ITEM_TYPE_CONSTANT:
+		i = ender_item_constant_new();
+		break;
+
+		default:
+		return NULL;
+	}
+	if (r->name != ENDER_CACHE_NONE)
+		ender_item_name_set(i, _ender_cache_string(h, r->name));
+	return i;
+}
+
+static Ender_Item * _ender_cache_item_ref(Ender_Item **items,
+		Ender_Item **externals, uint32_t idx)
+{
+	if (idx == ENDER_CACHE_NONE)
+		return NULL;
+	if (idx & ENDER_CACHE_EXTERNAL)
+		return ender_item_ref(externals[idx & ~ENDER_CACHE_EXTERNAL]);
+	return ender_item_ref(items[idx]);
+}
+
+static void _ender_cache_item_link(const Ender_Cache_Item *records,
+		unsigned int idx, Ender_Item **items, Ender_Item **externals,
+		const uint32_t *links)
+{
+	const Ender_Cache_Item *r = &records[idx];
+	Ender_Item *i = items[idx];
+	Ender_Item *other;
+	Ender_Value v;
+	unsigned int j;
+
+	switch (r->type)
+	{
+		case ENDER_ITEM_TYPE_FUNCTION:
+		for (j = 0; j < r->nchildren; j++)
+			ender_item_function_arg_add(i,
+					ender_item_ref(items[links[r->children + j]]));
+		other = _ender_cache_item_ref(items, externals, r->ref);
+		if (other)
+			ender_item_function_ret_set(i, other);
+		break;
+
+		case ENDER_ITEM_TYPE_ARG:
+		other = _ender_cache_item_ref(items, externals, r->ref);
+		if (other)
+			ender_item_arg_type_set(i, other);
+		break;
+
+		case ENDER_ITEM_TYPE_ATTR:
+		other = _ender_cache_item_ref(items, externals, r->ref);
+		if (other)
+			ender_item_attr_type_set(i, other);
+		other = _ender_cache_item_ref(items, externals, r->getter);
+		if (other)
+			ender_item_attr_getter_set(i, other);
+		other = _ender_cache_item_ref(items, externals, r->setter);
+		if (other)
+			ender_item_attr_setter_set(i, other);
+		break;
+
+		case ENDER_ITEM_TYPE_STRUCT:
+		/* the layout is already computed */
+		for (j = 0; j < r->nchildren; j++)
+		{
+			uint32_t field = links[r->children + j];
+
+			ender_item_struct_field_offset_add(i,
+					ender_item_ref(items[field]),
+					records[field].value);
+		}
+		ender_item_struct_size_set(i, r->value);
+		for (j = 0; j < r->nfunctions; j++)
+			ender_item_struct_function_add(i,
+					ender_item_ref(items[links[r->functions + j]]));
+		break;
+
+		case ENDER_ITEM_TYPE_OBJECT:
+		other = _ender_cache_item_ref(items, externals, r->ref);
+		if (other)
+			ender_item_object_inherit_set(i, other);
+		for (j = 0; j < r->nchildren; j++)
+			ender_item_object_prop_add(i,
+					ender_item_ref(items[links[r->children + j]]));
+		for (j = 0; j < r->nfunctions; j++)
+			ender_item_object_function_add(i,
+					ender_item_ref(items[links[r->functions + j]]));
+		break;
+
+		case ENDER_ITEM_TYPE_DEF:
+		other = _ender_cache_item_ref(items, externals, r->ref);
+		if (other)
+			ender_item_def_type_set(i, other);
+		for (j = 0; j < r->nfunctions; j++)
+			ender_item_def_function_add(i,
+					ender_item_ref(items[links[r->functions + j]]));
+		break;
+
+		case ENDER_ITEM_TYPE_ENUM:
+		for (j = 0; j < r->nchildren; j++)
+			ender_item_enum_value_add(i,
+					ender_item_ref(items[links[r->children + j]]));
+		break;
+
+		case ENDER_ITEM_TYPE_CONSTANT:
+		other = _ender_cache_item_ref(items, externals, r->ref);
+		if (other)
+			ender_item_constant_type_set(i, other);
+		memcpy(&v, &r->value, sizeof(int64_t));
+		ender_item_constant_value_set(i, &v);
+		break;
+
+		default:
+		break;
+	}
+}
+
+/* Check that every item an item links to exists */
+static Eina_Bool _ender_cache_item_linkable(const Ender_Cache_Item *records,
+		unsigned int idx, Ender_Item **items, const uint32_t *links)
+{
+	const Ender_Cache_Item *r = &records[idx];
+	unsigned int j;
+
+	if (r->ref != ENDER_CACHE_NONE && !(r->ref & ENDER_CACHE_EXTERNAL) &&
+			!items[r->ref])
+		return EINA_FALSE;
+	if (r->getter != ENDER_CACHE_NONE && !items[r->getter])
+		return EINA_FALSE;
+	if (r->setter != ENDER_CACHE_NONE && !items[r->setter])
+		return EINA_FALSE;
+	for (j = 0; j < r->nchildren; j++)
+	{
+		if (!items[links[r->children + j]])
+			return EINA_FALSE;
+	}
+	for (j = 0; j < r->nfunctions; j++)
+	{
+		if (!items[links[r->functions + j]])
+			return EINA_FALSE;
+	}
+	return EINA_TRUE;
+}
+
+/* Create a lib from an image. In case some items already exist, the kept ones
+ * are used instead of created and the skipped ones are not created at all
+ */
+static Ender_Lib * _ender_cache_lib_load(const Ender_Cache_Header *h,
+		Ender_Item **kept, const Eina_Bool *skip)
+{
+	const Ender_Cache_Item *records;
+	const uint32_t *links;
+	const uint32_t *ext;
+	Ender_Item **items = NULL;
+	Ender_Item **externals = NULL;
+	Ender_Lib *lib;
+	unsigned int i;
+
+	records = (const Ender_Cache_Item *)((const char *)h + h->items);
+	links = (const uint32_t *)((const char *)h + h->links);
+	ext = (const uint32_t *)((const char *)h + h->externals);
+
+	lib = ender_lib_new();
+	ender_lib_name_set(lib, _ender_cache_string(h, h->name));
+	ender_lib_version_set(lib, h->lib_version);
+	ender_lib_case_set(lib, h->kase);
+	ender_lib_notation_set(lib, h->notation);
+	/* the registry is already locked */
+	for (i = 0; i < h->ndeps; i++)
+	{
+		const Ender_Lib *dep;
+		const char *name;
+
+		name = _ender_cache_string(h, links[h->deps + i]);
+		dep = ender_lib_description_load(name);
+		if (!dep)
+		{
+			INF("Included library '%s' not found", name);
+			goto failed;
+		}
+		ender_lib_dependency_add(lib, dep);
+	}
+
+	/* the externals are looked up as the parser does */
+	externals = calloc(h->nexternals + 1, sizeof(Ender_Item *));
+	for (i = 0; i < h->nexternals; i++)
+	{
+		const char *name;
+
+		name = _ender_cache_string(h, ext[i]);
+		externals[i] = ender_lib_item_find(lib, name);
+		if (!externals[i])
+		{
+			INF("External item '%s' not found", name);
+			goto failed;
+		}
+	}
+
+	if (!_ender_cache_layout_check(h, records, externals, links))
+	{
+		WRN("A field is out of its struct");
+		goto failed;
+	}
+
+	items = calloc(h->nitems + 1, sizeof(Ender_Item *));
+	for (i = 0; i < h->nitems; i++)
+	{
+		if (kept && kept[i])
+		{
+			items[i] = kept[i];
+			continue;
+		}
+		if (skip && skip[i])
+			continue;
+		items[i] = _ender_cache_item_new(h, &records[i]);
+		if (!items[i])
+		{
+			INF("Unsupported item type %d", records[i].type);
+			goto failed;
+		}
+	}
+	for (i = 0; kept && i < h->nitems; i++)
+	{
+		if (kept[i] || !items[i])
+			continue;
+		if (!_ender_cache_item_linkable(records, i, items, links))
+		{
+			/* an item shared with a skipped one */
+			INF("Item %d can not be linked", i);
+			goto failed;
+		}
+	}
+	/* the children go first, so everything an item needs is already linked */
+	for (i = 0; i < h->nitems; i++)
+	{
+		if (kept && kept[i])
+			continue;
+		if (items[i])
+			_ender_cache_item_link(records, i, items, externals, links);
+	}
+	for (i = 0; i < h->nexported; i++)
+		ender_lib_item_add(lib, ender_item_ref(items[links[h->exported + i]]));
+	/* the lib owns every created item from now on */
+	for (i = 0; i < h->nitems; i++)
+	{
+		if (kept && kept[i])
+			continue;
+		if (items[i])
+			ender_lib_item_own(lib, items[i]);
+	}
+
+	for (i = 0; i < h->nexternals; i++)
+		ender_item_unref(externals[i]);
+	free(externals);
+	free(items);
+	return lib;
+
+failed:
+	/* nothing is linked yet */
+	for (i = 0; items && i < h->nitems; i++)
+	{
+		if (kept && kept[i])
+			continue;
+		ender_item_unref(items[i]);
+	}
+	for (i = 0; externals && i < h->nexternals && externals[i]; i++)
+		ender_item_unref(externals[i]);
+	free(externals);
+	free(items);
+	ender_lib_free(lib);
+	return NULL;
+}
+/*----------------------------------------------------------------------------*
+ *                                 reload                                     *
+ *----------------------------------------------------------------------------*/
+/* The owner of an item reached from more than one exported item */
+#define ENDER_CACHE_SHARED 0xfffffffe
+
+typedef struct _Ender_Cache_Diff
+{
+	const Ender_Cache_Header *h;
+	const Ender_Cache_Item *records;
+	const uint32_t *links;
+	const uint32_t *ext;
+	/* the index + 1 on the exported list of every exported item */
+	uint32_t *exported;
+	/* the exported item every item belongs to */
+	uint32_t *owners;
+} Ender_Cache_Diff;
+
+static void _ender_cache_diff_setup(Ender_Cache_Diff *d,
+		const Ender_Cache_Header *h)
+{
+	unsigned int i;
+
+	d->h = h;
+	d->records = (const Ender_Cache_Item *)((const char *)h + h->items);
+	d->links = (const uint32_t *)((const char *)h + h->links);
+	d->ext = (const uint32_t *)((const char *)h + h->externals);
+	d->exported = calloc(h->nitems + 1, sizeof(uint32_t));
+	d->owners = malloc((h->nitems + 1) * sizeof(uint32_t));
+	for (i = 0; i < h->nitems; i++)
+		d->owners[i] = ENDER_CACHE_NONE;
+	for (i = 0; i < h->nexported; i++)
+		d->exported[d->links[h->exported + i]] = i + 1;
+}
+
+static void _ender_cache_diff_cleanup(Ender_Cache_Diff *d)
+{
+	free(d->exported);
+	free(d->owners);
+}
+
+/* Every item that is not exported belongs to the exported item it is reached
+ * from. An item reached from several ones is shared
+ */
+static void _ender_cache_diff_own(Ender_Cache_Diff *d, uint32_t idx,
+		uint32_t owner)
+{
+	const Ender_Cache_Item *r;
+	unsigned int j;
+
+	if (idx == ENDER_CACHE_NONE || idx & ENDER_CACHE_EXTERNAL)
+		return;
+	if (d->exported[idx] && idx != owner)
+		return;
+	if (idx != owner)
+	{
+		if (d->owners[idx] == owner || d->owners[idx] == ENDER_CACHE_SHARED)
+			return;
+		if (d->owners[idx] != ENDER_CACHE_NONE)
+		{
+			d->owners[idx] = ENDER_CACHE_SHARED;
+			return;
+		}
+		d->owners[idx] = owner;
+	}
+	r = &d->records[idx];
+	_ender_cache_diff_own(d, r->ref, owner);
+	_ender_cache_diff_own(d, r->getter, owner);
+	_ender_cache_diff_own(d, r->setter, owner);
+	for (j = 0; j < r->nchildren; j++)
+		_ender_cache_diff_own(d, d->links[r->children + j], owner);
+	for (j = 0; j < r->nfunctions; j++)
+		_ender_cache_diff_own(d, d->links[r->functions + j], owner);
+}
+
+static Eina_Bool _ender_cache_string_equal(const char *s1, const char *s2)
+{
+	if (!s1 || !s2)
+		return s1 == s2;
+	return !strcmp(s1, s2);
+}
+
+static Eina_Bool _ender_cache_diff_equal(const Ender_Cache_Diff *o,
+		uint32_t oidx, const Ender_Cache_Diff *n, uint32_t nidx,
+		Eina_Bool root);
+
+static Eina_Bool _ender_cache_diff_comparable(const Ender_Cache_Diff *d,
+		uint32_t ref, uint32_t idx)
+{
+	if (ref == ENDER_CACHE_NONE || ref & ENDER_CACHE_EXTERNAL)
+		return EINA_TRUE;
+	return ref < idx || d->exported[ref];
+}
+
+static Eina_Bool _ender_cache_diff_links_equal(const Ender_Cache_Diff *o,
+		uint32_t olinks, const Ender_Cache_Diff *n, uint32_t nlinks,
+		uint32_t count)
+{
+	unsigned int j;
+
+	for (j = 0; j < count; j++)
+	{
+		if (!_ender_cache_diff_equal(o, o->links[olinks + j], n,
+				n->links[nlinks + j], EINA_FALSE))
+			return EINA_FALSE;
+	}
+	return EINA_TRUE;
+}
+
+/* Compare an item of the old image with an item of the new one. The exported
+ * items they refer to are compared by name only
+ */
+static Eina_Bool _ender_cache_diff_equal(const Ender_Cache_Diff *o,
+		uint32_t oidx, const Ender_Cache_Diff *n, uint32_t nidx,
+		Eina_Bool root)
+{
+	const Ender_Cache_Item *ro;
+	const Ender_Cache_Item *rn;
+
+	if (oidx == ENDER_CACHE_NONE || nidx == ENDER_CACHE_NONE)
+		return oidx == nidx;
+	if ((oidx & ENDER_CACHE_EXTERNAL) || (nidx & ENDER_CACHE_EXTERNAL))
+	{
+		if (!(oidx & nidx & ENDER_CACHE_EXTERNAL))
+			return EINA_FALSE;
+		return !strcmp(
+			_ender_cache_string(o->h, o->ext[oidx & ~ENDER_CACHE_EXTERNAL]),
+			_ender_cache_string(n->h, n->ext[nidx & ~ENDER_CACHE_EXTERNAL]));
+	}
+
+	ro = &o->records[oidx];
+	rn = &n->records[nidx];
+	if (!root && (o->exported[oidx] || n->exported[nidx]))
+	{
+		if (!o->exported[oidx] || !n->exported[nidx])
+			return EINA_FALSE;
+		return _ender_cache_string_equal(_ender_cache_string(o->h, ro->name),
+				_ender_cache_string(n->h, rn->name));
+	}
+	/* an item shared by several exported items is always a new one */
+	if (!root && (o->owners[oidx] == ENDER_CACHE_SHARED ||
+			n->owners[nidx] == ENDER_CACHE_SHARED))
+		return EINA_FALSE;
+
+	if (ro->type != rn->type || ro->flags != rn->flags ||
+			ro->direction != rn->direction || ro->transfer != rn->transfer ||
+			ro->value != rn->value)
+		return EINA_FALSE;
+	if (ro->nchildren != rn->nchildren || ro->nfunctions != rn->nfunctions)
+		return EINA_FALSE;
+	if (!_ender_cache_string_equal(_ender_cache_string(o->h, ro->name),
+			_ender_cache_string(n->h, rn->name)))
+		return EINA_FALSE;
+	if (!_ender_cache_string_equal(_ender_cache_string(o->h, ro->symname),
+			_ender_cache_string(n->h, rn->symname)))
+		return EINA_FALSE;
+	/* the children are stored before, so comparing them always ends. A ref
+	 * to an item stored after is only compared in case it is exported
+	 */
+	if (!_ender_cache_diff_comparable(o, ro->ref, oidx) ||
+			!_ender_cache_diff_comparable(n, rn->ref, nidx))
+		return EINA_FALSE;
+	if (!_ender_cache_diff_equal(o, ro->ref, n, rn->ref, EINA_FALSE))
+		return EINA_FALSE;
+	if (!_ender_cache_diff_equal(o, ro->getter, n, rn->getter, EINA_FALSE))
+		return EINA_FALSE;
+	if (!_ender_cache_diff_equal(o, ro->setter, n, rn->setter, EINA_FALSE))
+		return EINA_FALSE;
+	if (!_ender_cache_diff_links_equal(o, ro->children, n, rn->children,
+			ro->nchildren))
+		return EINA_FALSE;
+	if (!_ender_cache_diff_links_equal(o, ro->functions, n, rn->functions,
+			ro->nfunctions))
+		return EINA_FALSE;
+	return EINA_TRUE;
+}
+
+/* Check if an item refers to an exported item that is not kept */
+static Eina_Bool _ender_cache_diff_refers_changed(const Ender_Cache_Diff *n,
+		uint32_t idx, Ender_Item **kept)
+{
+	const Ender_Cache_Item *r = &n->records[idx];
+	uint32_t owner = n->owners[idx] == ENDER_CACHE_NONE ? idx : n->owners[idx];
+	uint32_t refs[3];
+	unsigned int j;
+
+	refs[0] = r->ref;
+	refs[1] = r->getter;
+	refs[2] = r->setter;
+	for (j = 0; j < 3; j++)
+	{
+		if (refs[j] == ENDER_CACHE_NONE || refs[j] & ENDER_CACHE_EXTERNAL)
+			continue;
+		if (refs[j] != owner && n->exported[refs[j]] && !kept[refs[j]])
+			return EINA_TRUE;
+	}
+	for (j = 0; j < r->nchildren; j++)
+	{
+		uint32_t child = n->links[r->children + j];
+
+		if (child != owner && n->exported[child] && !kept[child])
+			return EINA_TRUE;
+	}
+	for (j = 0; j < r->nfunctions; j++)
+	{
+		uint32_t child = n->links[r->functions + j];
+
+		if (child != owner && n->exported[child] && !kept[child])
+			return EINA_TRUE;
+	}
+	return EINA_FALSE;
+}
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+void ender_cache_init(void)
+{
+	const char *env;
+
+	/* ENDER_CACHE=0 disables the cache */
+	env = getenv("ENDER_CACHE");
+	if (env && !strcmp(env, "0"))
+		return;
+
+	env = getenv("ENDER_CACHE_DIR");
+	if (env)
+	{
+		_dir = strdup(env);
+	}
+	else if (getenv("XDG_CACHE_HOME"))
+	{
+		if (asprintf(&_dir, "%s/ender", getenv("XDG_CACHE_HOME")) < 0)
+			_dir = NULL;
+	}
+	else if (getenv("HOME"))
+	{
+		if (asprintf(&_dir, "%s/.cache/ender", getenv("HOME")) < 0)
+			_dir = NULL;
+	}
+	DBG("Using the cache dir '%s'", _dir);
+}
+
+void ender_cache_shutdown(void)
+{
+	free(_dir);
+	_dir = NULL;
+}
+
+/* Load and register a lib from its cache in case the cache is still valid for
+ * the source description. The registry must be locked, or every included lib
+ * registered already, as on the parsing threads of the eager loading
+ */
+const Ender_Lib * ender_cache_load(const char *name, const char *source)
+{
+	const Ender_Cache_Header *h;
+	Ender_Lib *lib = NULL;
+	struct stat st;
+	char *file;
+	int64_t mtime;
+	int64_t size;
+	uint32_t hash;
+	void *content;
+	int fd;
+
+	file = _ender_cache_file_get(name);
+	if (!file)
+		return NULL;
+	fd = open(file, O_RDONLY);
+	free(file);
+	if (fd < 0)
+		return NULL;
+	if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(Ender_Cache_Header))
+	{
+		close(fd);
+		return NULL;
+	}
+	content = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (content == MAP_FAILED)
+		return NULL;
+
+	h = content;
+	if (!_ender_cache_check(h, st.st_size))
+	{
+		WRN("Invalid cache for '%s'", name);
+		goto done;
+	}
+	if (strcmp(_ender_cache_string(h, h->name), name))
+		goto done;
+	/* the source is only read in case it has been touched */
+	if (!_ender_cache_source_get(source, &mtime, &size, NULL))
+		goto done;
+	if (mtime != h->mtime || size != h->source_size)
+	{
+		if (!_ender_cache_source_get(source, &mtime, &size, &hash))
+			goto done;
+		if (size != h->source_size || hash != h->hash)
+		{
+			DBG("Cache of '%s' is outdated", name);
+			goto done;
+		}
+	}
+
+	if (!_ender_cache_deps_check(h))
+	{
+		DBG("Cache of '%s' is outdated, an included library changed", name);
+		goto done;
+	}
+
+	DBG("Loading '%s' from the cache", name);
+	lib = _ender_cache_lib_load(h, NULL, NULL);
+	if (lib)
+	{
+		ender_lib_source_hash_set(lib, h->hash);
+		ender_lib_register(lib);
+	}
+done:
+	munmap(content, st.st_size);
+	return lib;
+}
+
+/* Create the image of a registered lib, the source description is optional */
+void * ender_cache_image_new(const Ender_Lib *lib, const char *source,
+		size_t *size)
+{
+	Ender_Cache_Writer w;
+	Ender_Cache_Header h;
+	Ender_Cache_Item *items = NULL;
+	Eina_List *deps;
+	Eina_List *exported = NULL;
+	Eina_List *l;
+	const Ender_Lib *dep;
+	void *image = NULL;
+	uint32_t offset;
+	unsigned int aitems = 0;
+	unsigned int j;
+	int type;
+
+	memset(&w, 0, sizeof(Ender_Cache_Writer));
+	memset(&h, 0, sizeof(Ender_Cache_Header));
+	w.lib = lib;
+	w.indexes = eina_hash_pointer_new(NULL);
+	w.externals = eina_hash_pointer_new(NULL);
+	w.offsets = eina_hash_string_superfast_new(NULL);
+
+	if (source && !_ender_cache_source_get(source, &h.mtime, &h.source_size,
+			&h.hash))
+		goto done;
+	strcpy(h.magic, ENDER_CACHE_MAGIC);
+	h.version = ENDER_CACHE_VERSION;
+	h.name = _ender_cache_writer_string(&w, ender_lib_name_get(lib));
+	h.lib_version = ender_lib_version_get(lib);
+	h.kase = ender_lib_case_get(lib);
+	h.notation = ender_lib_notation_get(lib);
+
+	deps = ender_lib_dependencies_get(lib);
+	h.deps = w.nlinks;
+	h.ndeps = eina_list_count(deps);
+	h.dep_hashes = h.deps + h.ndeps;
+	w.links = _ender_cache_grow(w.links, &w.alinks, w.nlinks + (h.ndeps * 2),
+			sizeof(uint32_t));
+	EINA_LIST_FOREACH(deps, l, dep)
+		w.links[w.nlinks++] = _ender_cache_writer_string(&w,
+				ender_lib_name_get(dep));
+	EINA_LIST_FREE(deps, dep)
+		w.links[w.nlinks++] = ender_lib_hash_get(dep);
+
+	for (type = ENDER_ITEM_TYPE_BASIC; type <= ENDER_ITEM_TYPE_DEF; type++)
+		exported = eina_list_merge(exported, ender_lib_item_list(lib, type));
+	h.exported = _ender_cache_writer_links(&w, exported, &h.nexported);
+
+	/* the items referred by others are indexed while writing */
+	for (j = 0; j < w.norder; j++)
+	{
+		items = _ender_cache_grow(items, &aitems, j + 1,
+				sizeof(Ender_Cache_Item));
+		_ender_cache_writer_item(&w, w.order[j], &items[j]);
+	}
+	h.nitems = w.norder;
+	h.nlinks = w.nlinks;
+	h.nexternals = w.next;
+	h.nstrings = w.nstrings;
+
+	offset = sizeof(Ender_Cache_Header);
+	h.items = offset;
+	offset += h.nitems * sizeof(Ender_Cache_Item);
+	h.links = offset;
+	offset += h.nlinks * sizeof(uint32_t);
+	h.externals = offset;
+	offset += h.nexternals * sizeof(uint32_t);
+	h.strings = offset;
+	offset += h.nstrings;
+	h.size = offset;
+
+	image = _ender_cache_writer_image(&w, &h, items);
+	if (image)
+		*size = h.size;
+done:
+	free(items);
+	free(w.order);
+	free(w.links);
+	free(w.ext);
+	free(w.strings);
+	eina_hash_free(w.offsets);
+	eina_hash_free(w.externals);
+	eina_hash_free(w.indexes);
+	return image;
+}
+
+/* Create a lib from an image, the lib is not registered. The registry must be
+ * locked
+ */
+Ender_Lib * ender_cache_image_load(const void *image, size_t size)
+{
+	const Ender_Cache_Header *h = image;
+
+	/* the tables are read in place */
+	if ((uintptr_t)image % sizeof(int64_t))
+		return NULL;
+	if (!_ender_cache_check(h, size))
+		return NULL;
+	return _ender_cache_lib_load(h, NULL, NULL);
+}
+
+/* The name of the lib of an image, only the header is checked */
+const char * ender_cache_image_name_get(const void *image, size_t size)
+{
+	const Ender_Cache_Header *h = image;
+
+	if (!_ender_cache_header_check(h, size))
+		return NULL;
+	return _ender_cache_string(h, h->name);
+}
+
+/* The hash of the source of an image, or of the image itself in case it was
+ * created without a source
+ */
+uint32_t ender_cache_image_hash_get(const void *image, size_t size)
+{
+	const Ender_Cache_Header *h = image;
+
+	if (h->hash)
+		return h->hash;
+	return eina_hash_superfast(image, size);
+}
+
+/* The hash of a source description */
+Eina_Bool ender_cache_source_hash_get(const char *source, uint32_t *hash)
+{
+	int64_t mtime;
+	int64_t size;
+
+	return _ender_cache_source_get(source, &mtime, &size, hash);
+}
+
+/* The names of the libs an image depends on */
+Eina_List * ender_cache_image_deps_get(const void *image, size_t size)
+{
+	const Ender_Cache_Header *h = image;
+	const uint32_t *links;
+	Eina_List *ret = NULL;
+	unsigned int i;
+
+	if (!_ender_cache_check(h, size))
+		return NULL;
+	links = (const uint32_t *)((const char *)h + h->links);
+	for (i = 0; i < h->ndeps; i++)
+		ret = eina_list_append(ret, strdup(_ender_cache_string(h,
+				links[h->deps + i])));
+	return ret;
+}
+
+/* Write the cache of a registered lib */
+Eina_Bool ender_cache_save(const Ender_Lib *lib, const char *source)
+{
+	Eina_Bool ret = EINA_FALSE;
+	char *file;
+	void *image;
+	size_t size;
+
+	file = _ender_cache_file_get(ender_lib_name_get(lib));
+	if (!file)
+		return EINA_FALSE;
+	if (mkdir(_dir, 0700) < 0 && errno != EEXIST)
+	{
+		WRN("Impossible to create the cache dir '%s'", _dir);
+		free(file);
+		return EINA_FALSE;
+	}
+
+	image = ender_cache_image_new(lib, source, &size);
+	if (image)
+	{
+		ret = _ender_cache_write(image, size, file);
+		free(image);
+	}
+	if (!ret)
+		WRN("Impossible to write the cache of '%s'", ender_lib_name_get(lib));
+	free(file);
+	return ret;
+}
+
+/* Update a registered lib with a new image of it. The exported items that
+ * are equal on both images are kept as they are, with their prepared calls
+ * and symbols, only the changed and new ones are created. The registry must
+ * be locked
+ */
+Eina_Bool ender_cache_lib_reload(Ender_Lib *lib, const void *image,
+		size_t size)
+{
+	const Ender_Cache_Header *h = image;
+	const Ender_Cache_Header *old_h;
+	Ender_Cache_Diff o;
+	Ender_Cache_Diff n;
+	Ender_Lib *other;
+	Ender_Item **kept;
+	Eina_Bool *skip;
+	Eina_Hash *names;
+	Eina_Bool changed;
+	void *old_image;
+	size_t old_size;
+	unsigned int i;
+	unsigned int nkept = 0;
+	unsigned int nmatched = 0;
+
+	if ((uintptr_t)image % sizeof(int64_t))
+		return EINA_FALSE;
+	if (!_ender_cache_check(h, size))
+	{
+		ERR("Invalid image for lib '%s'", ender_lib_name_get(lib));
+		return EINA_FALSE;
+	}
+	if (strcmp(_ender_cache_string(h, h->name), ender_lib_name_get(lib)))
+	{
+		ERR("The image is not of lib '%s'", ender_lib_name_get(lib));
+		return EINA_FALSE;
+	}
+	/* the current lib is compared through its own image */
+	old_image = ender_cache_image_new(lib, NULL, &old_size);
+	if (!old_image)
+		return EINA_FALSE;
+	old_h = old_image;
+
+	_ender_cache_diff_setup(&o, old_h);
+	_ender_cache_diff_setup(&n, h);
+	for (i = 0; i < old_h->nexported; i++)
+	{
+		uint32_t idx = o.links[old_h->exported + i];
+		_ender_cache_diff_own(&o, idx, idx);
+	}
+	for (i = 0; i < h->nexported; i++)
+	{
+		uint32_t idx = n.links[h->exported + i];
+		_ender_cache_diff_own(&n, idx, idx);
+	}
+
+	names = eina_hash_string_superfast_new(NULL);
+	for (i = 0; i < old_h->nexported; i++)
+	{
+		uint32_t idx = o.links[old_h->exported + i];
+		const char *name = _ender_cache_string(old_h, o.records[idx].name);
+
+		if (name)
+			eina_hash_add(names, name, &o.links[old_h->exported + i]);
+	}
+
+	kept = calloc(h->nitems + 1, sizeof(Ender_Item *));
+	skip = calloc(h->nitems + 1, sizeof(Eina_Bool));
+	for (i = 0; i < h->nexported; i++)
+	{
+		uint32_t idx = n.links[h->exported + i];
+		const uint32_t *oidx;
+		const char *name;
+		Ender_Item *item;
+
+		name = _ender_cache_string(h, n.records[idx].name);
+		if (!name)
+			continue;
+		oidx = eina_hash_find(names, name);
+		if (!oidx)
+			continue;
+		nmatched++;
+		if (!_ender_cache_diff_equal(&o, *oidx, &n, idx, EINA_TRUE))
+			continue;
+		item = ender_lib_item_find(lib, name);
+		if (!item || ender_item_lib_get(item) != lib)
+			continue;
+		kept[idx] = item;
+	}
+	eina_hash_free(names);
+
+	/* an item that refers to a changed one must change too */
+	do
+	{
+		changed = EINA_FALSE;
+		for (i = 0; i < h->nitems; i++)
+		{
+			uint32_t owner;
+
+			owner = n.owners[i] == ENDER_CACHE_NONE ? i : n.owners[i];
+			if (owner == ENDER_CACHE_SHARED || !n.exported[owner] ||
+					!kept[owner])
+				continue;
+			if (!_ender_cache_diff_refers_changed(&n, i, kept))
+				continue;
+			kept[owner] = NULL;
+			changed = EINA_TRUE;
+		}
+	} while (changed);
+
+	/* the items of the kept ones already exist */
+	for (i = 0; i < h->nitems; i++)
+	{
+		uint32_t owner = n.owners[i];
+
+		if (kept[i])
+			nkept++;
+		else if (owner != ENDER_CACHE_NONE && owner != ENDER_CACHE_SHARED &&
+				kept[owner])
+			skip[i] = EINA_TRUE;
+	}
+
+	other = _ender_cache_lib_load(h, kept, skip);
+	if (!other && nkept)
+	{
+		INF("Reloading every item of lib '%s'", ender_lib_name_get(lib));
+		nkept = 0;
+		other = _ender_cache_lib_load(h, NULL, NULL);
+	}
+	if (other)
+	{
+		INF("Lib '%s' reloaded, %u items kept, %u changed, %u added, "
+				"%u removed", ender_lib_name_get(lib), nkept,
+				nmatched - nkept, h->nexported - nmatched,
+				old_h->nexported - nmatched);
+		ender_lib_merge(lib, other);
+	}
+
+	free(skip);
+	free(kept);
+	_ender_cache_diff_cleanup(&n);
+	_ender_cache_diff_cleanup(&o);
+	free(old_image);
+	return other ? EINA_TRUE : EINA_FALSE;
+}
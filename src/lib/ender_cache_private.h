@@ -0,0 +1,36 @@
+/* ENDER - Enesim's descriptor library
+ * Copyright (C) 2010 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ENDER_CACHE_PRIVATE_H_
+#define _ENDER_CACHE_PRIVATE_H_
+
+void ender_cache_init(void);
+void ender_cache_shutdown(void);
+const Ender_Lib * ender_cache_load(const char *name, const char *source);
+Eina_Bool ender_cache_save(const Ender_Lib *lib, const char *source);
+void * ender_cache_image_new(const Ender_Lib *lib, const char *source,
+		size_t *size);
+Ender_Lib * ender_cache_image_load(const void *image, size_t size);
+const char * ender_cache_image_name_get(const void *image, size_t size);
+Eina_List * ender_cache_image_deps_get(const void *image, size_t size);
+uint32_t ender_cache_image_hash_get(const void *image, size_t size);
+Eina_Bool ender_cache_source_hash_get(const char *source, uint32_t *hash);
+Eina_Bool ender_cache_lib_reload(Ender_Lib *lib, const void *image,
+		size_t size);
+
+#endif
@@ -0,0 +1,535 @@
+/* ENDER - Enesim's descriptor library
+ * Copyright (C) 2010 - 2012 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ender_private.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ender_main.h"
+#include "ender_value.h"
+#include "ender_item.h"
+#include "ender_lib.h"
+
+#include "ender_main_private.h"
+#include "ender_lib_private.h"
+#include "ender_call_thunk_private.h"
+#include "ender_call_jit_private.h"
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#define ENDER_CALL_JIT_SUPPORTED 1
+#include <sys/mman.h>
+#endif
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+/* The JIT generates one native thunk per function, with the prototype of an
+ * Ender_Call_Thunk. The thunk loads every value straight into the registers
+ * or the stack following the x86-64 System V ABI, calls the symbol and
+ * stores the return value
+ */
+#ifdef ENDER_CALL_JIT_SUPPORTED
+/* The thunks are appended to a page mapped twice, they are written through
+ * the writable view and run from the executable one, so no view is ever
+ * writable and executable. Every thunk starts on its own cache line, nothing
+ * is written where other threads might be running
+ */
+#define ENDER_CALL_JIT_PAGE_SIZE (64 * 1024)
+#define ENDER_CALL_JIT_ALIGN 64
+
+struct _Ender_Call_Jit_Page
+{
+	unsigned char *rw;
+	unsigned char *rx;
+	size_t size;
+	size_t used;
+	/* the thunks not released yet */
+	int thunks;
+};
+
+typedef struct _Ender_Call_Jit_Buffer
+{
+	unsigned char *data;
+	size_t len;
+} Ender_Call_Jit_Buffer;
+
+/* the pages and the perf map are shared by the threads preparing calls */
+static Eina_Lock _lock;
+static Eina_List *_pages = NULL;
+/* the page where the new thunks are appended */
+static Ender_Call_Jit_Page *_current = NULL;
+static FILE *_perf_map = NULL;
+static Eina_Bool _enabled = EINA_FALSE;
+
+/* rdi, rsi, rdx, rcx, r8, r9 */
+static const int _gprs[] = { 7, 6, 2, 1, 8, 9 };
+#define ENDER_CALL_JIT_GPRS (sizeof(_gprs) / sizeof(int))
+#define ENDER_CALL_JIT_XMMS 8
+
+static void _emit8(Ender_Call_Jit_Buffer *b, unsigned char v)
+{
+	b->data[b->len++] = v;
+}
+
+static void _emit32(Ender_Call_Jit_Buffer *b, uint32_t v)
+{
+	memcpy(b->data + b->len, &v, sizeof(v));
+	b->len += sizeof(v);
+}
+
+static void _emit64(Ender_Call_Jit_Buffer *b, uint64_t v)
+{
+	memcpy(b->data + b->len, &v, sizeof(v));
+	b->len += sizeof(v);
+}
+
+/* load the value at [rbx + disp] into a general purpose register, extending
+ * the small integers to 32 bits
+ */
+static void _ender_call_jit_gpr_load(Ender_Call_Jit_Buffer *b, int reg,
+		Ender_Value_Type vt, int32_t disp)
+{
+	switch (vt)
+	{
+		/* movzx r32, byte [rbx + disp] */
+		case ENDER_VALUE_TYPE_BOOL:
+		case ENDER_VALUE_TYPE_UINT8:
+		if (reg >= 8) _emit8(b, 0x44);
+		_emit8(b, 0x0f);
+		_emit8(b, 0xb6);
+		break;
+
+		/* movsx r32, byte [rbx + disp] */
+		case ENDER_VALUE_TYPE_INT8:
+		if (reg >= 8) _emit8(b, 0x44);
+		_emit8(b, 0x0f);
+		_emit8(b, 0xbe);
+		break;
+
+		/* mov r32, [rbx + disp] */
+		case ENDER_VALUE_TYPE_UINT32:
+		case ENDER_VALUE_TYPE_INT32:
+		if (reg >= 8) _emit8(b, 0x44);
+		_emit8(b, 0x8b);
+		break;
+
+		/* mov r64, [rbx + disp] */
+		default:
+		_emit8(b, reg >= 8 ? 0x4c : 0x48);
+		_emit8(b, 0x8b);
+		break;
+	}
+	_emit8(b, 0x80 | ((reg & 7) << 3) | 0x03);
+	_emit32(b, disp);
+}
+
+/* movsd xmm, [rbx + disp] */
+static void _ender_call_jit_xmm_load(Ender_Call_Jit_Buffer *b, int xmm,
+		int32_t disp)
+{
+	_emit8(b, 0xf2);
+	_emit8(b, 0x0f);
+	_emit8(b, 0x10);
+	_emit8(b, 0x80 | (xmm << 3) | 0x03);
+	_emit32(b, disp);
+}
+
+static void _ender_call_jit_ret_store(Ender_Call_Jit_Buffer *b,
+		Ender_Value_Type vt)
+{
+	/* test r12, r12 */
+	_emit8(b, 0x4d);
+	_emit8(b, 0x85);
+	_emit8(b, 0xe4);
+	/* jz over the store, every store below is at most 10 bytes */
+	_emit8(b, 0x74);
+	switch (vt)
+	{
+		case ENDER_VALUE_TYPE_DOUBLE:
+		_emit8(b, 6);
+		/* movsd [r12], xmm0 */
+		_emit8(b, 0xf2);
+		_emit8(b, 0x41);
+		_emit8(b, 0x0f);
+		_emit8(b, 0x11);
+		_emit8(b, 0x04);
+		_emit8(b, 0x24);
+		return;
+
+		/* movzx eax, al */
+		case ENDER_VALUE_TYPE_BOOL:
+		case ENDER_VALUE_TYPE_UINT8:
+		_emit8(b, 7);
+		_emit8(b, 0x0f);
+		_emit8(b, 0xb6);
+		_emit8(b, 0xc0);
+		break;
+
+		/* movsx rax, al */
+		case ENDER_VALUE_TYPE_INT8:
+		_emit8(b, 8);
+		_emit8(b, 0x48);
+		_emit8(b, 0x0f);
+		_emit8(b, 0xbe);
+		_emit8(b, 0xc0);
+		break;
+
+		/* mov eax, eax */
+		case ENDER_VALUE_TYPE_UINT32:
+		_emit8(b, 6);
+		_emit8(b, 0x89);
+		_emit8(b, 0xc0);
+		break;
+
+		/* movsxd rax, eax */
+		case ENDER_VALUE_TYPE_INT32:
+		_emit8(b, 7);
+		_emit8(b, 0x48);
+		_emit8(b, 0x63);
+		_emit8(b, 0xc0);
+		break;
+
+		default:
+		_emit8(b, 4);
+		break;
+	}
+	/* mov [r12], rax */
+	_emit8(b, 0x49);
+	_emit8(b, 0x89);
+	_emit8(b, 0x04);
+	_emit8(b, 0x24);
+}
+
+static size_t _ender_call_jit_generate(Ender_Call_Jit_Buffer *b, void *sym,
+		Ender_Value_Type *ret, int nargs, Ender_Value_Type *args)
+{
+	unsigned int ngprs = 0;
+	unsigned int nxmms = 0;
+	unsigned int nstack = 0;
+	uint32_t frame;
+	int i;
+
+	/* first count the args that go on the stack */
+	for (i = 0; i < nargs; i++)
+	{
+		if (args[i] == ENDER_VALUE_TYPE_DOUBLE)
+		{
+			if (nxmms++ >= ENDER_CALL_JIT_XMMS)
+				nstack++;
+		}
+		else
+		{
+			if (ngprs++ >= ENDER_CALL_JIT_GPRS)
+				nstack++;
+		}
+	}
+	/* after the return address and the two pushes the stack must remain
+	 * aligned to 16 bytes at the call
+	 */
+	frame = ((nstack * 8 + 15) & ~15) + 8;
+
+	/* push rbx; push r12 */
+	_emit8(b, 0x53);
+	_emit8(b, 0x41);
+	_emit8(b, 0x54);
+	/* sub rsp, frame */
+	_emit8(b, 0x48);
+	_emit8(b, 0x81);
+	_emit8(b, 0xec);
+	_emit32(b, frame);
+	/* mov rbx, rsi (the args); mov r12, rdx (the return value) */
+	_emit8(b, 0x48);
+	_emit8(b, 0x89);
+	_emit8(b, 0xf3);
+	_emit8(b, 0x49);
+	_emit8(b, 0x89);
+	_emit8(b, 0xd4);
+
+	/* now place every arg */
+	ngprs = nxmms = nstack = 0;
+	for (i = 0; i < nargs; i++)
+	{
+		int32_t disp = i * sizeof(Ender_Value);
+
+		if (args[i] == ENDER_VALUE_TYPE_DOUBLE && nxmms < ENDER_CALL_JIT_XMMS)
+		{
+			_ender_call_jit_xmm_load(b, nxmms++, disp);
+		}
+		else if (args[i] != ENDER_VALUE_TYPE_DOUBLE && ngprs < ENDER_CALL_JIT_GPRS)
+		{
+			_ender_call_jit_gpr_load(b, _gprs[ngprs++], args[i], disp);
+		}
+		else
+		{
+			/* a stack slot, go through rax */
+			_ender_call_jit_gpr_load(b, 0, args[i] == ENDER_VALUE_TYPE_DOUBLE ?
+					ENDER_VALUE_TYPE_UINT64 : args[i], disp);
+			/* mov [rsp + slot], rax */
+			_emit8(b, 0x48);
+			_emit8(b, 0x89);
+			_emit8(b, 0x84);
+			_emit8(b, 0x24);
+			_emit32(b, nstack++ * 8);
+		}
+	}
+
+	/* movabs r11, sym */
+	_emit8(b, 0x49);
+	_emit8(b, 0xbb);
+	_emit64(b, (uint64_t)(uintptr_t)sym);
+	/* mov al, number of vector registers in case the symbol is variadic */
+	_emit8(b, 0xb0);
+	_emit8(b, nxmms);
+	/* call r11 */
+	_emit8(b, 0x41);
+	_emit8(b, 0xff);
+	_emit8(b, 0xd3);
+
+	if (ret)
+		_ender_call_jit_ret_store(b, *ret);
+
+	/* add rsp, frame; pop r12; pop rbx; ret */
+	_emit8(b, 0x48);
+	_emit8(b, 0x81);
+	_emit8(b, 0xc4);
+	_emit32(b, frame);
+	_emit8(b, 0x41);
+	_emit8(b, 0x5c);
+	_emit8(b, 0x5b);
+	_emit8(b, 0xc3);
+
+	return b->len;
+}
+
+static void _ender_call_jit_page_free(void *data)
+{
+	Ender_Call_Jit_Page *page = data;
+
+	munmap(page->rw, page->size);
+	munmap(page->rx, page->size);
+	free(page);
+}
+
+static Ender_Call_Jit_Page * _ender_call_jit_page_new(size_t len)
+{
+	Ender_Call_Jit_Page *page;
+	long page_size;
+	int fd;
+
+	page_size = sysconf(_SC_PAGESIZE);
+	page = calloc(1, sizeof(Ender_Call_Jit_Page));
+	page->size = len > ENDER_CALL_JIT_PAGE_SIZE ? len : ENDER_CALL_JIT_PAGE_SIZE;
+	page->size = ((page->size + page_size - 1) / page_size) * page_size;
+	fd = memfd_create("ender-jit", MFD_CLOEXEC);
+	if (fd < 0)
+	{
+		ERR("Impossible to create the memory of the JIT");
+		free(page);
+		return NULL;
+	}
+	if (ftruncate(fd, page->size) < 0)
+	{
+		ERR("Impossible to allocate a new page for the JIT");
+		close(fd);
+		free(page);
+		return NULL;
+	}
+	page->rw = mmap(NULL, page->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			fd, 0);
+	page->rx = mmap(NULL, page->size, PROT_READ | PROT_EXEC, MAP_SHARED,
+			fd, 0);
+	close(fd);
+	if (page->rw == MAP_FAILED || page->rx == MAP_FAILED)
+	{
+		ERR("Impossible to map a new page for the JIT");
+		if (page->rw != MAP_FAILED)
+			munmap(page->rw, page->size);
+		if (page->rx != MAP_FAILED)
+			munmap(page->rx, page->size);
+		free(page);
+		return NULL;
+	}
+	_pages = eina_list_append(_pages, page);
+
+	return page;
+}
+
+/* Unmap a page once its thunks are released. The lookups might still be
+ * using the lib of the thunks, the page goes through the retire list too. The
+ * lock must be taken
+ */
+static void _ender_call_jit_page_retire(Ender_Call_Jit_Page *page)
+{
+	if (page->thunks)
+		return;
+	if (page == _current)
+		_current = NULL;
+	_pages = eina_list_remove(_pages, page);
+	ender_lib_retire(page, _ender_call_jit_page_free);
+}
+
+/* Append the code to the current page. The thunk is complete before its
+ * address is returned, so the threads that get it see the whole code. The
+ * lock must be taken
+ */
+static void * _ender_call_jit_install(const unsigned char *code, size_t len,
+		Ender_Call_Jit_Page **ret)
+{
+	Ender_Call_Jit_Page *page;
+	Ender_Call_Jit_Page *old;
+	size_t size;
+	void *thunk;
+
+	size = (len + ENDER_CALL_JIT_ALIGN - 1) & ~(ENDER_CALL_JIT_ALIGN - 1);
+	page = _current;
+	if (!page || page->used + size > page->size)
+	{
+		page = _ender_call_jit_page_new(size);
+		if (!page)
+			return NULL;
+		old = _current;
+		_current = page;
+		if (old)
+			_ender_call_jit_page_retire(old);
+	}
+	memcpy(page->rw + page->used, code, len);
+	thunk = page->rx + page->used;
+	__builtin___clear_cache((char *)thunk, (char *)thunk + len);
+	page->used += size;
+	page->thunks++;
+	*ret = page;
+
+	return thunk;
+}
+
+static void _ender_call_jit_perf_map_open(void)
+{
+	char *file = NULL;
+
+	if (asprintf(&file, "/tmp/perf-%d.map", getpid()) < 0)
+		return;
+	_perf_map = fopen(file, "a");
+	if (!_perf_map)
+		WRN("Impossible to open the perf map '%s'", file);
+	free(file);
+}
+#endif
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+void ender_call_jit_init(void)
+{
+#ifdef ENDER_CALL_JIT_SUPPORTED
+	const char *env;
+
+	eina_lock_new(&_lock);
+	env = getenv("ENDER_JIT");
+	if (!env || strcmp(env, "1"))
+		return;
+
+	INF("Using the JIT for the function calls");
+	_enabled = EINA_TRUE;
+	_ender_call_jit_perf_map_open();
+#else
+	if (getenv("ENDER_JIT"))
+		INF("The JIT is not supported on this architecture, using libffi");
+#endif
+}
+
+void ender_call_jit_shutdown(void)
+{
+#ifdef ENDER_CALL_JIT_SUPPORTED
+	Ender_Call_Jit_Page *page;
+
+	EINA_LIST_FREE(_pages, page)
+		_ender_call_jit_page_free(page);
+	_current = NULL;
+	if (_perf_map)
+	{
+		fclose(_perf_map);
+		_perf_map = NULL;
+	}
+	_enabled = EINA_FALSE;
+	eina_lock_free(&_lock);
+#endif
+}
+
+/* Get a native thunk for the given prototype or NULL in case the JIT is not
+ * enabled or the prototype is not supported. The page of the thunk must be
+ * released once the thunk is not used anymore
+ */
+Ender_Call_Thunk ender_call_jit_get(const char *name, void *sym,
+		Ender_Value_Type *ret, int nargs, Ender_Value_Type *args,
+		Ender_Call_Jit_Page **page)
+{
+#ifdef ENDER_CALL_JIT_SUPPORTED
+	Ender_Call_Jit_Buffer b;
+	void *code;
+	int i;
+
+	if (!_enabled)
+		return NULL;
+
+	if (ret && *ret >= ENDER_VALUE_TYPES)
+		return NULL;
+	for (i = 0; i < nargs; i++)
+	{
+		if (args[i] >= ENDER_VALUE_TYPES)
+			return NULL;
+	}
+
+	/* the prologue, call and epilogue take less than 64 bytes and every
+	 * arg at most 16 bytes
+	 */
+	b.data = malloc(64 + (nargs * 16));
+	b.len = 0;
+	_ender_call_jit_generate(&b, sym, ret, nargs, args);
+
+	eina_lock_take(&_lock);
+	code = _ender_call_jit_install(b.data, b.len, page);
+	if (code && _perf_map)
+	{
+		fprintf(_perf_map, "%lx %zx ender_thunk_%s\n",
+				(unsigned long)(uintptr_t)code, b.len, name);
+		fflush(_perf_map);
+	}
+	eina_lock_release(&_lock);
+	free(b.data);
+	if (!code)
+		return NULL;
+
+	DBG("Thunk for '%s' generated at %p", name, code);
+	return (Ender_Call_Thunk)code;
+#else
+	return NULL;
+#endif
+}
+
+/* Release a thunk, its page is unmapped once every thunk on it is released */
+void ender_call_jit_release(Ender_Call_Jit_Page *page)
+{
+#ifdef ENDER_CALL_JIT_SUPPORTED
+	if (!page) return;
+
+	eina_lock_take(&_lock);
+	page->thunks--;
+	_ender_call_jit_page_retire(page);
+	eina_lock_release(&_lock);
+#endif
+}
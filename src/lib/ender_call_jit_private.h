@@ -0,0 +1,31 @@
+/* ENDER - Enesim's descriptor library
+ * Copyright (C) 2010 - 2012 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ENDER_CALL_JIT_PRIVATE_H_
+#define _ENDER_CALL_JIT_PRIVATE_H_
+
+typedef struct _Ender_Call_Jit_Page Ender_Call_Jit_Page;
+
+void ender_call_jit_init(void);
+void ender_call_jit_shutdown(void);
+Ender_Call_Thunk ender_call_jit_get(const char *name, void *sym,
+		Ender_Value_Type *ret, int nargs, Ender_Value_Type *args,
+		Ender_Call_Jit_Page **page);
+void ender_call_jit_release(Ender_Call_Jit_Page *page);
+
+#endif
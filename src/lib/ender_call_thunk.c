@@ -0,0 +1,176 @@
+/* ENDER - Enesim's descriptor library
+ * Copyright (C) 2010 - 2012 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ender_private.h"
+
+#include "ender_main.h"
+#include "ender_value.h"
+
+#include "ender_main_private.h"
+#include "ender_call_thunk_private.h"
+/*============================================================================*
+ *                                  Local                                     *
+ *============================================================================*/
+/* Every value type with its C type, the member of the value that holds it as
+ * an argument and the member that holds it as a return value. Integers
+ * are returned widened as libffi does
+ */
+#define ENDER_CALL_THUNK_TYPES(X) \
+	X(BOOL, Eina_Bool, b, u64) \
+	X(UINT8, uint8_t, u8, u64) \
+	X(INT8, int8_t, i8, i64) \
+	X(UINT32, uint32_t, u32, u64) \
+	X(INT32, int32_t, i32, i64) \
+	X(UINT64, uint64_t, u64, u64) \
+	X(INT64, int64_t, i64, i64) \
+	X(DOUBLE, double, d, d) \
+	X(STRING, void *, ptr, ptr) \
+	X(POINTER, void *, ptr, ptr) \
+	X(SIZE, size_t, sz, sz)
+
+/* void f(void) */
+static void _ender_call_thunk_void(void *sym, Ender_Value *args,
+		Ender_Value *ret)
+{
+	((void (*)(void))sym)();
+}
+
+/* void f(ptr) */
+static void _ender_call_thunk_void_ptr(void *sym, Ender_Value *args,
+		Ender_Value *ret)
+{
+	((void (*)(void *))sym)(args[0].ptr);
+}
+
+/* TYPE f(void), i.e ctors */
+#define ENDER_CALL_THUNK_STATIC(NAME, TYPE, ARG, RET) \
+static void _ender_call_thunk_static_##NAME(void *sym, Ender_Value *args, \
+		Ender_Value *ret) \
+{ \
+	TYPE r; \
+ \
+	r = ((TYPE (*)(void))sym)(); \
+	if (ret) ret->RET = r; \
+}
+
+/* TYPE f(ptr), i.e getters */
+#define ENDER_CALL_THUNK_GETTER(NAME, TYPE, ARG, RET) \
+static void _ender_call_thunk_getter_##NAME(void *sym, Ender_Value *args, \
+		Ender_Value *ret) \
+{ \
+	TYPE r; \
+ \
+	r = ((TYPE (*)(void *))sym)(args[0].ptr); \
+	if (ret) ret->RET = r; \
+}
+
+/* void f(ptr, TYPE), i.e setters */
+#define ENDER_CALL_THUNK_SETTER(NAME, TYPE, ARG, RET) \
+static void _ender_call_thunk_setter_##NAME(void *sym, Ender_Value *args, \
+		Ender_Value *ret) \
+{ \
+	((void (*)(void *, TYPE))sym)(args[0].ptr, args[1].ARG); \
+}
+
+/* Eina_Bool f(ptr, TYPE), i.e setters that might fail */
+#define ENDER_CALL_THUNK_BOOL_SETTER(NAME, TYPE, ARG, RET) \
+static void _ender_call_thunk_bool_setter_##NAME(void *sym, Ender_Value *args, \
+		Ender_Value *ret) \
+{ \
+	Eina_Bool r; \
+ \
+	r = ((Eina_Bool (*)(void *, TYPE))sym)(args[0].ptr, args[1].ARG); \
+	if (ret) ret->u64 = r; \
+}
+
+ENDER_CALL_THUNK_TYPES(ENDER_CALL_THUNK_STATIC)
+ENDER_CALL_THUNK_TYPES(ENDER_CALL_THUNK_GETTER)
+ENDER_CALL_THUNK_TYPES(ENDER_CALL_THUNK_SETTER)
+ENDER_CALL_THUNK_TYPES(ENDER_CALL_THUNK_BOOL_SETTER)
+
+#define ENDER_CALL_THUNK_ENTRY(PREFIX, NAME) \
+	[ENDER_VALUE_TYPE_##NAME] = _ender_call_thunk_##PREFIX##_##NAME,
+#define ENDER_CALL_THUNK_STATIC_ENTRY(NAME, TYPE, ARG, RET) \
+	ENDER_CALL_THUNK_ENTRY(static, NAME)
+#define ENDER_CALL_THUNK_GETTER_ENTRY(NAME, TYPE, ARG, RET) \
+	ENDER_CALL_THUNK_ENTRY(getter, NAME)
+#define ENDER_CALL_THUNK_SETTER_ENTRY(NAME, TYPE, ARG, RET) \
+	ENDER_CALL_THUNK_ENTRY(setter, NAME)
+#define ENDER_CALL_THUNK_BOOL_SETTER_ENTRY(NAME, TYPE, ARG, RET) \
+	ENDER_CALL_THUNK_ENTRY(bool_setter, NAME)
+
+static Ender_Call_Thunk _statics[ENDER_VALUE_TYPES] = {
+	ENDER_CALL_THUNK_TYPES(ENDER_CALL_THUNK_STATIC_ENTRY)
+};
+
+static Ender_Call_Thunk _getters[ENDER_VALUE_TYPES] = {
+	ENDER_CALL_THUNK_TYPES(ENDER_CALL_THUNK_GETTER_ENTRY)
+};
+
+static Ender_Call_Thunk _setters[ENDER_VALUE_TYPES] = {
+	ENDER_CALL_THUNK_TYPES(ENDER_CALL_THUNK_SETTER_ENTRY)
+};
+
+static Ender_Call_Thunk _bool_setters[ENDER_VALUE_TYPES] = {
+	ENDER_CALL_THUNK_TYPES(ENDER_CALL_THUNK_BOOL_SETTER_ENTRY)
+};
+
+static Eina_Bool _ender_call_thunk_is_pointer(Ender_Value_Type vt)
+{
+	return vt == ENDER_VALUE_TYPE_POINTER || vt == ENDER_VALUE_TYPE_STRING;
+}
+/*============================================================================*
+ *                                 Global                                     *
+ *============================================================================*/
+/* Get the thunk for a given prototype or NULL if there is none. In such case
+ * the call must be done through libffi
+ */
+Ender_Call_Thunk ender_call_thunk_get(Ender_Value_Type *ret, int nargs,
+		Ender_Value_Type *args)
+{
+	if (ret && *ret >= ENDER_VALUE_TYPES)
+		return NULL;
+
+	switch (nargs)
+	{
+		case 0:
+		if (!ret)
+			return _ender_call_thunk_void;
+		return _statics[*ret];
+
+		case 1:
+		if (!_ender_call_thunk_is_pointer(args[0]))
+			return NULL;
+		if (!ret)
+			return _ender_call_thunk_void_ptr;
+		return _getters[*ret];
+
+		case 2:
+		if (!_ender_call_thunk_is_pointer(args[0]))
+			return NULL;
+		if (args[1] >= ENDER_VALUE_TYPES)
+			return NULL;
+		if (!ret)
+			return _setters[args[1]];
+		if (*ret == ENDER_VALUE_TYPE_BOOL)
+			return _bool_setters[args[1]];
+		return NULL;
+
+		default:
+		return NULL;
+	}
+}
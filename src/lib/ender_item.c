@@ -27,9 +27,22 @@
 /*============================================================================*
  *                                  Local                                     *
  *============================================================================*/
+/* the names are shared, so the exceptions are found by comparing pointers */
+static const char *_exception_name = NULL;
 /*============================================================================*
  *                                 Global                                     *
  *============================================================================*/
+void ender_item_init(void)
+{
+	_exception_name = eina_stringshare_add("eina.error");
+}
+
+void ender_item_shutdown(void)
+{
+	eina_stringshare_del(_exception_name);
+	_exception_name = NULL;
+}
+
 Ender_Item * ender_item_new(Ender_Item_Descriptor *desc, void *data)
 {
 	Ender_Item *thiz;
@@ -60,15 +73,7 @@ void ender_item_type_set(Ender_Item *thiz, Ender_Item_Type type)
 
 void ender_item_name_set(Ender_Item *thiz, const char *name)
 {
-	if (thiz->name)
-	{
-		free(thiz->name);
-		thiz->name = NULL;
-	}
-	if (name)
-	{
-		thiz->name = strdup(name);
-	}
+	eina_stringshare_replace(&thiz->name, name);
 }
 
 void ender_item_parent_set(Ender_Item *thiz, Ender_Item *parent)
@@ -96,27 +101,61 @@ void * ender_item_sym_get(Ender_Item *thiz, const char *name)
 
 }
 
-void ender_item_cycle_ref_set(Ender_Item *thiz, int ref)
+int ender_item_ref_count(Ender_Item *thiz)
 {
-	thiz->cycle_ref = ref;
+	return ENDER_ATOMIC_GET(&thiz->ref);
 }
 
-int ender_item_ref_count(Ender_Item *thiz)
+/* Once immortal, the ref and unref do nothing, the item must be destroyed
+ * explicitly with ender_item_deinit() and ender_item_free(). This is used for
+ * the items of a lib, which are destroyed when the lib is
+ */
+void ender_item_immortal_set(Ender_Item *thiz)
 {
-	return thiz->ref;
+	thiz->immortal = EINA_TRUE;
+}
+
+Eina_Bool ender_item_immortal_get(Ender_Item *thiz)
+{
+	return thiz->immortal;
+}
+
+/* Release the data of the item but keep the item itself, this way the items
+ * that refer to it can still be released
+ */
+void ender_item_deinit(Ender_Item *thiz)
+{
+	if (!thiz->desc)
+		return;
+	if (thiz->desc->deinit)
+		thiz->desc->deinit(thiz);
+	thiz->desc = NULL;
+	thiz->data = NULL;
+}
+
+void ender_item_free(Ender_Item *thiz)
+{
+	ender_item_deinit(thiz);
+	eina_stringshare_del(thiz->name);
+	free(thiz);
 }
 /*============================================================================*
  *                                   API                                      *
  *============================================================================*/
 /**
  * @brief Increase the reference counter of an item
+ *
+ * The items of a registered library live as long as the library, for them
+ * this function and @ref ender_item_unref do nothing.
  * @param[in] thiz The item
  * @return The input parameter @a thiz for programming convenience
  */
 EAPI Ender_Item * ender_item_ref(Ender_Item *thiz)
 {
 	if (!thiz) return thiz;
-	thiz->ref++;
+	if (thiz->immortal) return thiz;
+	/* items are shared between threads */
+	ENDER_ATOMIC_ADD(&thiz->ref, 1);
 	return thiz;
 }
 
@@ -127,19 +166,14 @@ EAPI Ender_Item * ender_item_ref(Ender_Item *thiz)
 EAPI void ender_item_unref(Ender_Item *thiz)
 {
 	if (!thiz) return;
-	thiz->ref--;
-	if (thiz->ref == thiz->cycle_ref)
+	if (thiz->immortal) return;
+	if (!ENDER_ATOMIC_ADD(&thiz->ref, -1))
 	{
-		if (thiz->desc->deinit)
-			thiz->desc->deinit(thiz);
 		if (thiz->parent)
 		{
 			CRI("Removing last reference of '%s' with a parent", thiz->name);
 		}
-		if (thiz->name)
-			free(thiz->name);
-
-		free(thiz);
+		ender_item_free(thiz);
 	}
 }
 
@@ -226,7 +260,7 @@ EAPI const Ender_Lib * ender_item_lib_get(Ender_Item *thiz)
 	{
 		if (!thiz->parent)
 			return NULL;
-		return ender_item_lib_get(thiz);
+		return ender_item_lib_get(thiz->parent);
 	}
 	else
 	{
@@ -245,7 +279,7 @@ EAPI Eina_Bool ender_item_is_exception(Ender_Item *i)
 {
 	if (!i) return EINA_FALSE;
 
-	if (!strcmp(ender_item_name_get(i), "eina.error"))
+	if (ender_item_name_get(i) == _exception_name)
 		return EINA_TRUE;
 	else
 		return EINA_FALSE;
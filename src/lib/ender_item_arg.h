@@ -32,8 +32,8 @@
 typedef enum _Ender_Item_Arg_Direction
 {
 	/**
-	 * Is an IN argument. @ref Ender_Struct_Group are always passed
-	 * by reference
+	 * Is an IN argument. @ref Ender_Struct_Group are passed by reference
+	 * unless the argument has the @ref ENDER_ITEM_ARG_FLAG_BY_VALUE flag
 	 */
 	ENDER_ITEM_ARG_DIRECTION_IN,
 	/**
@@ -62,6 +62,12 @@ typedef enum _Ender_Item_Arg_Flag
 	ENDER_ITEM_ARG_FLAG_IS_RETURN  = (1 << 0),
 	/** In a callback, this argument is the user provided data */
 	ENDER_ITEM_ARG_FLAG_IS_CLOSURE = (1 << 1),
+	/**
+	 * The @ref Ender_Struct_Group is passed by value. The value of such
+	 * argument is a pointer to the struct, in case of a return value it
+	 * must point to the memory where the struct will be stored
+	 */
+	ENDER_ITEM_ARG_FLAG_BY_VALUE   = (1 << 2),
 } Ender_Item_Arg_Flag;
 
 EAPI Ender_Item * ender_item_arg_type_get(Ender_Item *i);
@@ -54,6 +54,8 @@ typedef struct _Ender_Item_Attr
 	Ender_Item *getter;
 	Ender_Item_Attr_Getter_Type getter_type;
 	Ender_Item_Transfer getter_transfer;
+	/* the struct filled by an inout getter, if any */
+	Ender_Item *getter_struct;
 	ssize_t offset;
 	int flags;
 } Ender_Item_Attr;
@@ -76,6 +78,7 @@ static void _ender_item_attr_deinit(Ender_Item *i)
 
 	thiz = ENDER_ITEM_ATTR(i);
 	ender_item_unref(thiz->type);
+	ender_item_unref(thiz->getter_struct);
 	if (thiz->getter)
 	{
 		ender_item_parent_set(thiz->getter, NULL);
@@ -194,28 +197,6 @@ static Eina_Bool _ender_item_attr_value_get(Ender_Item *getter,
 		case ENDER_ITEM_ATTR_GETTER_TYPE_INOUT:
 		{
 			Ender_Value args[2];
-			Ender_Item *arg;
-			Ender_Item *arg_content;
-
-			/* In case is an out struct and no pointer, create it
-			 * for the user
-			 */
-			arg = ender_item_function_args_at(getter, 1);
-			arg_content = ender_item_arg_type_get(arg);
-			if (ender_item_type_get(arg_content) == ENDER_ITEM_TYPE_STRUCT)
-			{
-				if (!v->ptr)
-				{
-					size_t s;
-
-					DBG("Creating new struct for out arg");
-					s = ender_item_struct_size_get(arg_content);
-					v->ptr = calloc(1, s);
-					/* TODO set the correct xfer */
-				}
-			}
-			ender_item_unref(arg_content);
-			ender_item_unref(arg);
 
 			args[0].ptr = o;
 			args[1] = *v;
@@ -239,6 +220,30 @@ static Eina_Bool _ender_item_attr_value_get(Ender_Item *getter,
 	return ret;
 }
 
+/* Get the struct an inout getter fills, the getter is called with a pointer
+ * to the storage of the struct
+ */
+static Ender_Item * _ender_item_attr_getter_struct_get(Ender_Item *getter,
+		Ender_Item_Attr_Getter_Type type)
+{
+	Ender_Item *arg;
+	Ender_Item *ret;
+
+	if (type != ENDER_ITEM_ATTR_GETTER_TYPE_INOUT &&
+			type != ENDER_ITEM_ATTR_GETTER_TYPE_INOUT_THROW)
+		return NULL;
+
+	arg = ender_item_function_args_at(getter, 1);
+	ret = ender_item_arg_type_get(arg);
+	ender_item_unref(arg);
+	if (ender_item_type_get(ret) != ENDER_ITEM_TYPE_STRUCT)
+	{
+		ender_item_unref(ret);
+		return NULL;
+	}
+	return ret;
+}
+
 static Eina_Bool _ender_item_attr_value_set(Ender_Item *setter, void *o,
 		Ender_Value *v, Eina_Error *err)
 {
@@ -307,6 +312,11 @@ void ender_item_attr_getter_set(Ender_Item *i, Ender_Item *f)
 		ender_item_unref(thiz->getter);
 		thiz->getter = NULL;
 	}
+	if (thiz->getter_struct)
+	{
+		ender_item_unref(thiz->getter_struct);
+		thiz->getter_struct = NULL;
+	}
 	if (!_ender_item_attr_getter_type_get(f, &thiz->getter_type,
 			&thiz->getter_transfer))
 	{
@@ -314,10 +324,28 @@ void ender_item_attr_getter_set(Ender_Item *i, Ender_Item *f)
 		ender_item_unref(f);
 		return;
 	}
+	thiz->getter_struct = _ender_item_attr_getter_struct_get(f,
+			thiz->getter_type);
 	thiz->getter = f;
 	ender_item_parent_set(f, i);
 }
 
+Ender_Item * ender_item_attr_setter_get(Ender_Item *i)
+{
+	Ender_Item_Attr *thiz;
+
+	thiz = ENDER_ITEM_ATTR(i);
+	return ender_item_ref(thiz->setter);
+}
+
+Ender_Item * ender_item_attr_getter_get(Ender_Item *i)
+{
+	Ender_Item_Attr *thiz;
+
+	thiz = ENDER_ITEM_ATTR(i);
+	return ender_item_ref(thiz->getter);
+}
+
 void ender_item_attr_offset_set(Ender_Item *i, ssize_t offset)
 {
 	Ender_Item_Attr *thiz;
@@ -438,6 +466,11 @@ EAPI int ender_item_attr_flags_get(Ender_Item *i)
 
 /**
  * Get the value from an attribute
+ *
+ * In case the getter fills a struct, @a v ptr can point to the storage
+ * of the struct. If it is NULL a new instance is taken from the struct pool,
+ * @a xfer is set to @ref ENDER_ITEM_TRANSFER_FULL and the caller must release
+ * it with @ref ender_item_struct_instance_free
  * @param i The attribute to get the value from
  * @param o The object instance that has such attribute
  * @param[out] xfer The transfer of the value. It is responsible of the caller
@@ -456,9 +489,28 @@ EAPI Eina_Bool ender_item_attr_value_get(Ender_Item *i, void *o,
 	thiz = ENDER_ITEM_ATTR(i);
 	if (thiz->getter)
 	{
+		Eina_Bool created = EINA_FALSE;
+
 		if (xfer) *xfer = thiz->getter_transfer;
-		return _ender_item_attr_value_get(thiz->getter,
+		/* In case is an out struct and no pointer, create it
+		 * for the user
+		 */
+		if (thiz->getter_struct && !v->ptr)
+		{
+			DBG("Creating new struct for out arg");
+			v->ptr = ender_item_struct_instance_new(thiz->getter_struct);
+			if (xfer) *xfer = ENDER_ITEM_TRANSFER_FULL;
+			created = EINA_TRUE;
+		}
+		ret = _ender_item_attr_value_get(thiz->getter,
 				thiz->getter_type, o, v, err);
+		if (!ret && created)
+		{
+			ender_item_struct_instance_free(thiz->getter_struct,
+					v->ptr);
+			v->ptr = NULL;
+		}
+		return ret;
 	}
 
 	parent = ender_item_parent_get(i);
@@ -483,6 +535,43 @@ done:
 	return ret;
 }
 
+/**
+ * Get the value from an attribute using a caller provided buffer
+ *
+ * In case the getter fills a struct, the struct is written on @a buf and
+ * no memory is allocated, the value is owned by the caller. This is useful
+ * for bindings that read the same struct attribute many times, like a
+ * rectangle on every frame. Any other value is get as with
+ * @ref ender_item_attr_value_get
+ * @param i The attribute to get the value from
+ * @param o The object instance that has such attribute
+ * @param buf The storage of the struct
+ * @param len The size of @a buf
+ * @param[out] xfer The transfer of the value
+ * @param v The value of the attribute
+ * @param[out] err In case the return value is EINA_FALSE, an error will be set
+ * @return EINA_TRUE if success, EINA_FALSE otherwise
+ */
+EAPI Eina_Bool ender_item_attr_value_buffer_get(Ender_Item *i, void *o,
+		void *buf, size_t len, Ender_Item_Transfer *xfer,
+		Ender_Value *v, Eina_Error *err)
+{
+	Ender_Item_Attr *thiz;
+
+	thiz = ENDER_ITEM_ATTR(i);
+	if (thiz->getter_struct)
+	{
+		if (!buf || len < ender_item_struct_size_get(thiz->getter_struct))
+		{
+			ERR("Buffer too small for '%s'",
+					ender_item_name_get(thiz->getter_struct));
+			return EINA_FALSE;
+		}
+		v->ptr = buf;
+	}
+	return ender_item_attr_value_get(i, o, xfer, v, err);
+}
+
 /**
  * Set the value from an attribute
  * @param i The attribute to set the value
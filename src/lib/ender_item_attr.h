@@ -46,6 +46,9 @@ EAPI Ender_Item * ender_item_attr_type_get(Ender_Item *i);
 EAPI ssize_t ender_item_attr_offset_get(Ender_Item *i);
 EAPI Eina_Bool ender_item_attr_value_get(Ender_Item *i, void *o, Ender_Item_Transfer *xfer,
 		Ender_Value *v, Eina_Error *err);
+EAPI Eina_Bool ender_item_attr_value_buffer_get(Ender_Item *i, void *o,
+		void *buf, size_t len, Ender_Item_Transfer *xfer,
+		Ender_Value *v, Eina_Error *err);
 EAPI Eina_Bool ender_item_attr_value_set(Ender_Item *i, void *o, Ender_Value *v, Eina_Error *err);
 EAPI int ender_item_attr_flags_get(Ender_Item *i);
 
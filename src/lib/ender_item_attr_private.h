@@ -26,6 +26,8 @@ void ender_item_attr_flags_set(Ender_Item *i, int flags);
 void ender_item_attr_type_set(Ender_Item *i, Ender_Item *t);
 void ender_item_attr_setter_set(Ender_Item *i, Ender_Item *f);
 void ender_item_attr_getter_set(Ender_Item *i, Ender_Item *f);
+Ender_Item * ender_item_attr_setter_get(Ender_Item *i);
+Ender_Item * ender_item_attr_getter_get(Ender_Item *i);
 void ender_item_attr_offset_set(Ender_Item *i, ssize_t offset);
 
 #endif
@@ -17,6 +17,8 @@
  */
 #include "ender_private.h"
 
+#include <time.h>
+
 #include "ender_main.h"
 #include "ender_value.h"
 #include "ender_item.h"
@@ -24,11 +26,18 @@
 #include "ender_item_basic.h"
 #include "ender_item_arg.h"
 #include "ender_item_def.h"
+#include "ender_item_struct.h"
+#include "ender_lib.h"
 
 #include "ender_main_private.h"
+#include "ender_value_private.h"
 #include "ender_item_private.h"
 #include "ender_item_function_private.h"
 #include "ender_item_arg_private.h"
+#include "ender_item_struct_private.h"
+#include "ender_lib_private.h"
+#include "ender_call_thunk_private.h"
+#include "ender_call_jit_private.h"
 /*============================================================================*
  *                                  Local                                     *
  *============================================================================*/
@@ -38,89 +47,129 @@ typedef struct _Ender_Item_Function
 {
 	Ender_Item *ret;
 	Eina_List *args;
+	/* the synthetic self arg of a method and return arg of a ctor, created
+	 * on demand
+	 */
+	Ender_Item *self;
+	Ender_Item *ctor_ret;
 	int throw_position;
 	char *symname;
 	int flags;
 	void *sym;
+	/* the call interface, built once on the first call */
+	Ender_Call *call;
+	/* in case of a callback, the call interface shared by every closure
+	 * and the closures ready to be reused. The closures can be created
+	 * and freed from any thread, the pool is guarded by the lock
+	 */
+	Ender_Call *closure_call;
+	Eina_List *closures;
+	int closures_live;
+	Eina_Lock closures_lock;
+	/* the profiling counters, updated atomically from any thread */
+	unsigned long long calls;
+	unsigned long long errors;
+	uint64_t total_time;
+	uint64_t max_time;
 } Ender_Item_Function;
 
+struct _Ender_Call
+{
+	/* the function this call was prepared from. Only set on the calls
+	 * returned to the user, the function's own call does not ref it
+	 */
+	Ender_Item *item;
+	void *sym;
+	/* the direct call in case the prototype has one */
+	Ender_Call_Thunk thunk;
+	/* the page of a generated thunk, only on the function's own call */
+	Ender_Call_Jit_Page *page;
+	ffi_cif cif;
+	ffi_type **ffi_args;
+	int nargs;
+	int throw_position;
+};
+
+struct _Ender_Closure
+{
+	/* the callback this closure implements */
+	Ender_Item *item;
+	ffi_closure *closure;
+	void *code;
+	Ender_Closure_Cb cb;
+	void *data;
+};
+
+static int _closures_live = 0;
+static int _closures_pooled = 0;
+static Eina_Bool _profile = EINA_FALSE;
+
+/* Create an arg of the type of the parent of the function. Once the function
+ * is owned by a lib the arg is kept by the function and is immortal too, so
+ * it lives as long as the lib. In case another thread cached the arg first,
+ * that one is used
+ */
+static Ender_Item * _ender_item_function_parent_arg_get(Ender_Item *i,
+		Ender_Item **cache, const char *name)
+{
+	Ender_Item *arg;
+
+	arg = ENDER_ATOMIC_GET(cache);
+	if (arg)
+		return arg;
+
+	arg = ender_item_arg_new();
+	ender_item_name_set(arg, name);
+	ender_item_arg_type_set(arg, ender_item_parent_get(i));
+	ender_item_arg_direction_set(arg, ENDER_ITEM_ARG_DIRECTION_IN);
+	ender_item_arg_transfer_set(arg, ENDER_ITEM_TRANSFER_FULL);
+	if (!ender_item_immortal_get(i))
+		return arg;
+
+	ender_item_immortal_set(arg);
+	if (!ENDER_ATOMIC_CAS(cache, NULL, arg))
+	{
+		ender_item_free(arg);
+		return ENDER_ATOMIC_GET(cache);
+	}
+	return arg;
+}
+
+static Ender_Item * _ender_item_function_self_get(Ender_Item *i,
+		Ender_Item_Function *thiz)
+{
+	return _ender_item_function_parent_arg_get(i, &thiz->self, "self");
+}
+
 /* TODO handle the direction */
-static ffi_type * _ender_item_function_arg_ffi_to(Ender_Item *i)
+static Ender_Value_Type _ender_item_function_arg_value_type_get(Ender_Item *i)
 {
 	Ender_Item_Type type;
 
 	if (!i)
 	{
 		WRN("No item found");
-		return &ffi_type_pointer;
+		return ENDER_VALUE_TYPE_POINTER;
 	}
 
 	type = ender_item_type_get(i);
 	switch (type)
 	{
 		case ENDER_ITEM_TYPE_BASIC:
-		{
-			Ender_Value_Type vt;
-
-			vt = ender_item_basic_value_type_get(i);
-			switch (vt)
-			{
-				case ENDER_VALUE_TYPE_BOOL:
-				return &ffi_type_uint8;
-				break;
-
-				case ENDER_VALUE_TYPE_UINT8:
-				return &ffi_type_uint8;
-				break;
-
-				case ENDER_VALUE_TYPE_INT8:
-				return &ffi_type_sint8;
-				break;
-
-				case ENDER_VALUE_TYPE_UINT32:
-				return &ffi_type_uint32;
-				break;
-
-				case ENDER_VALUE_TYPE_INT32:
-				return &ffi_type_sint32;
-				break;
-
-				case ENDER_VALUE_TYPE_UINT64:
-				return &ffi_type_uint64;
-				break;
-
-				case ENDER_VALUE_TYPE_INT64:
-				return &ffi_type_sint64;
-				break;
-
-				case ENDER_VALUE_TYPE_DOUBLE:
-				return &ffi_type_double;
-				break;
-
-				case ENDER_VALUE_TYPE_STRING:
-				case ENDER_VALUE_TYPE_POINTER:
-				return &ffi_type_pointer;
-				break;
-
-				default:
-				ERR("Unsupported item type '%d'", vt);
-				return &ffi_type_pointer;
-				break;
-			}
-		}
+		return ender_item_basic_value_type_get(i);
 		break;
 
 		case ENDER_ITEM_TYPE_ENUM:
-		return &ffi_type_sint32;
+		return ENDER_VALUE_TYPE_INT32;
 		break;
 
 		case ENDER_ITEM_TYPE_DEF:
 		{
 			Ender_Item *other;
-			ffi_type *ret;
+			Ender_Value_Type ret;
 
 			other = ender_item_def_type_get(i);
-			ret = _ender_item_function_arg_ffi_to(other);
+			ret = _ender_item_function_arg_value_type_get(other);
 			ender_item_unref(other);
 			return ret;
 		}
@@ -129,15 +178,355 @@ static ffi_type * _ender_item_function_arg_ffi_to(Ender_Item *i)
 		case ENDER_ITEM_TYPE_STRUCT:
 		case ENDER_ITEM_TYPE_FUNCTION:
 		case ENDER_ITEM_TYPE_OBJECT:
-		return &ffi_type_pointer;
+		return ENDER_VALUE_TYPE_POINTER;
 		break;
 
 		default:
 		ERR("Unsupported item type '%d'", type);
-		return &ffi_type_pointer;
+		return ENDER_VALUE_TYPE_POINTER;
+		break;
+	}
+}
+
+/* Get the ffi type of a struct passed by value */
+static ffi_type * _ender_item_function_struct_ffi_get(Ender_Item *i)
+{
+	Ender_Item_Type type;
+
+	if (!i)
+		return NULL;
+
+	type = ender_item_type_get(i);
+	switch (type)
+	{
+		case ENDER_ITEM_TYPE_STRUCT:
+		return ender_item_struct_ffi_type_get(i);
+		break;
+
+		case ENDER_ITEM_TYPE_DEF:
+		{
+			Ender_Item *other;
+			ffi_type *ret;
+
+			other = ender_item_def_type_get(i);
+			ret = _ender_item_function_struct_ffi_get(other);
+			ender_item_unref(other);
+			return ret;
+		}
+		break;
+
+		default:
+		ERR("Only structs can be passed by value");
+		return NULL;
+		break;
+	}
+}
+
+/* Get the ffi type and the value type of an arg or return value */
+static ffi_type * _ender_item_function_arg_ffi_get(Ender_Item *arg,
+		Ender_Value_Type *vt)
+{
+	Ender_Item *type;
+	ffi_type *ret = NULL;
+
+	type = ender_item_arg_type_get(arg);
+	*vt = _ender_item_function_arg_value_type_get(type);
+	if (ender_item_arg_flags_get(arg) & ENDER_ITEM_ARG_FLAG_BY_VALUE)
+		ret = _ender_item_function_struct_ffi_get(type);
+	ender_item_unref(type);
+
+	if (!ret)
+		ret = ender_value_type_ffi_to(*vt);
+	return ret;
+}
+
+static void _ender_call_free(Ender_Call *call)
+{
+	ender_call_jit_release(call->page);
+	free(call->ffi_args);
+	free(call);
+}
+
+static Ender_Call * _ender_call_dup(Ender_Call *src)
+{
+	Ender_Call *call;
+
+	call = calloc(1, sizeof(Ender_Call));
+	*call = *src;
+	/* the thunk is released with the call of the function */
+	call->page = NULL;
+	call->ffi_args = calloc(src->nargs ? src->nargs : 1, sizeof(ffi_type *));
+	memcpy(call->ffi_args, src->ffi_args, src->nargs * sizeof(ffi_type *));
+	/* the cif is already prepared, just point to our own types */
+	call->cif.arg_types = call->ffi_args;
+
+	return call;
+}
+
+static void _ender_item_function_unprepare(Ender_Item_Function *thiz)
+{
+	Ender_Closure *closure;
+
+	if (thiz->call)
+	{
+		_ender_call_free(thiz->call);
+		thiz->call = NULL;
+	}
+	eina_lock_take(&thiz->closures_lock);
+	/* every closure, even the pooled ones, points to the cif of the
+	 * closure call, so it is kept while some closure is in use
+	 */
+	if (thiz->closures_live)
+	{
+		WRN("The callback has %d closures in use, keeping its interface",
+				thiz->closures_live);
+		eina_lock_release(&thiz->closures_lock);
+		return;
+	}
+	EINA_LIST_FREE(thiz->closures, closure)
+	{
+		ffi_closure_free(closure->closure);
+		free(closure);
+		ENDER_ATOMIC_ADD(&_closures_pooled, -1);
+	}
+	if (thiz->closure_call)
+	{
+		_ender_call_free(thiz->closure_call);
+		thiz->closure_call = NULL;
+	}
+	eina_lock_release(&thiz->closures_lock);
+}
+
+/* Build the ffi call interface for the given symbol. In case there is no
+ * symbol only the call interface is built
+ */
+static Ender_Call * _ender_item_function_call_new(Ender_Item *i,
+		Ender_Item_Function *thiz, void *sym)
+{
+	Ender_Call *call;
+	Ender_Item *a;
+	Eina_List *l;
+	Ender_Value_Type *vargs;
+	Ender_Value_Type vret;
+	Eina_Bool has_ret = EINA_TRUE;
+	Eina_Bool by_value = EINA_FALSE;
+	ffi_type *ffi_ret = &ffi_type_void;
+	ffi_status status;
+	int ffi_arg = 0;
+
+	call = calloc(1, sizeof(Ender_Call));
+	call->sym = sym;
+	call->throw_position = ender_item_function_throw_position_get(i);
+
+	/* pass the args as ffi args */
+	call->nargs = eina_list_count(thiz->args);
+	if (thiz->flags & ENDER_ITEM_FUNCTION_FLAG_IS_METHOD)
+		call->nargs++;
+
+	call->ffi_args = calloc(call->nargs ? call->nargs : 1, sizeof(ffi_type *));
+	vargs = calloc(call->nargs ? call->nargs : 1, sizeof(Ender_Value_Type));
+
+	/* fill in the args */
+	if (thiz->flags & ENDER_ITEM_FUNCTION_FLAG_IS_METHOD)
+	{
+		vargs[ffi_arg] = ENDER_VALUE_TYPE_POINTER;
+		call->ffi_args[ffi_arg++] = &ffi_type_pointer;
+	}
+
+	EINA_LIST_FOREACH(thiz->args, l, a)
+	{
+		call->ffi_args[ffi_arg] = _ender_item_function_arg_ffi_get(a,
+				&vargs[ffi_arg]);
+		if (call->ffi_args[ffi_arg]->type == FFI_TYPE_STRUCT)
+			by_value = EINA_TRUE;
+		ffi_arg++;
+	}
+
+	/* a ctor always returns an instance of the parent, no need to create
+	 * the return arg for it
+	 */
+	if (thiz->flags & ENDER_ITEM_FUNCTION_FLAG_CTOR)
+	{
+		vret = ENDER_VALUE_TYPE_POINTER;
+		ffi_ret = &ffi_type_pointer;
+	}
+	else if (thiz->ret)
+	{
+		ffi_ret = _ender_item_function_arg_ffi_get(thiz->ret, &vret);
+		if (ffi_ret->type == FFI_TYPE_STRUCT)
+			by_value = EINA_TRUE;
+	}
+	else
+	{
+		has_ret = EINA_FALSE;
+	}
+
+	/* check if we can avoid libffi for this prototype, the structs passed
+	 * by value are handled by libffi only
+	 */
+	if (sym && !by_value)
+	{
+		call->thunk = ender_call_thunk_get(has_ret ? &vret : NULL,
+				call->nargs, vargs);
+		if (!call->thunk)
+			call->thunk = ender_call_jit_get(thiz->symname, sym,
+					has_ret ? &vret : NULL, call->nargs, vargs,
+					&call->page);
+	}
+	free(vargs);
+
+	if ((status = ffi_prep_cif(&call->cif, FFI_DEFAULT_ABI, call->nargs,
+			ffi_ret, call->ffi_args)) != FFI_OK)
+	{
+		ERR("FFI error '%d' preparing '%s'", status,
+				ender_item_name_get(i));
+		_ender_call_free(call);
+		return NULL;
+	}
+
+	return call;
+}
+
+static Eina_Bool _ender_item_function_sym_load(Ender_Item *i,
+		Ender_Item_Function *thiz)
+{
+	/* the background resolution might load it at the same time */
+	if (!ENDER_ATOMIC_GET(&thiz->sym))
+	{
+		void *sym;
+
+		DBG("Loading symbol '%s'", thiz->symname);
+		sym = ender_item_sym_get(i, thiz->symname);
+		if (sym)
+			ENDER_ATOMIC_CAS(&thiz->sym, NULL, sym);
+	}
+	return ENDER_ATOMIC_GET(&thiz->sym) ? EINA_TRUE : EINA_FALSE;
+}
+
+/* Resolve the symbol and build the call. This is done only once so the
+ * steady state call does not need to walk the args nor allocate
+ */
+static Eina_Bool _ender_item_function_prepare(Ender_Item *i,
+		Ender_Item_Function *thiz)
+{
+	Ender_Call *call;
+
+	if (thiz->flags & ENDER_ITEM_FUNCTION_FLAG_CALLBACK)
+	{
+		ERR("The callback '%s' can not be called",
+				ender_item_name_get(i));
+		return EINA_FALSE;
+	}
+
+	if (!_ender_item_function_sym_load(i, thiz))
+	{
+		CRI("Impossible to load the symbol '%s'", thiz->symname);
+		return EINA_FALSE;
+	}
+
+	call = _ender_item_function_call_new(i, thiz, thiz->sym);
+	if (!call)
+		return EINA_FALSE;
+	/* another thread might have prepared the function meanwhile */
+	if (!ENDER_ATOMIC_CAS(&thiz->call, NULL, call))
+		_ender_call_free(call);
+	return EINA_TRUE;
+}
+
+/* Called by libffi whenever the C side calls a closure */
+static void _ender_closure_dispatch(ffi_cif *cif, void *ret, void **args,
+		void *data)
+{
+	Ender_Closure *thiz = data;
+	Ender_Value values[cif->nargs + 1];
+	Ender_Value retval;
+	unsigned int arg;
+
+	/* every ender value is a union, copy just the bytes of the type */
+	for (arg = 0; arg < cif->nargs; arg++)
+	{
+		memset(&values[arg], 0, sizeof(Ender_Value));
+		if (cif->arg_types[arg]->type == FFI_TYPE_STRUCT)
+			values[arg].ptr = args[arg];
+		else
+			memcpy(&values[arg], args[arg], cif->arg_types[arg]->size);
+	}
+	memset(&retval, 0, sizeof(Ender_Value));
+	/* a struct is returned in place */
+	if (cif->rtype->type == FFI_TYPE_STRUCT)
+		retval.ptr = ret;
+	thiz->cb(thiz->item, values, &retval, thiz->data);
+
+	/* libffi expects the integers smaller than a register to be widened */
+	switch (cif->rtype->type)
+	{
+		case FFI_TYPE_VOID:
+		break;
+
+		case FFI_TYPE_UINT8:
+		*(ffi_arg *)ret = retval.u8;
+		break;
+
+		case FFI_TYPE_SINT8:
+		*(ffi_sarg *)ret = retval.i8;
+		break;
+
+		case FFI_TYPE_UINT32:
+		*(ffi_arg *)ret = retval.u32;
+		break;
+
+		case FFI_TYPE_SINT32:
+		*(ffi_sarg *)ret = retval.i32;
+		break;
+
+		case FFI_TYPE_STRUCT:
+		break;
+
+		default:
+		memcpy(ret, &retval, cif->rtype->size);
 		break;
 	}
-	
+}
+
+static uint64_t _ender_item_function_time_get(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return ((uint64_t)t.tv_sec * 1000000000ULL) + t.tv_nsec;
+}
+
+/* The same as a normal call, but keeping the profiling counters */
+static Eina_Bool _ender_item_function_call_profile(Ender_Item *i,
+		Ender_Item_Function *thiz, Ender_Value *args, Ender_Value *retval)
+{
+	uint64_t start;
+	uint64_t max;
+	uint64_t t;
+
+	ENDER_ATOMIC_ADD(&thiz->calls, 1);
+	if (!ENDER_ATOMIC_GET(&thiz->call) && !_ender_item_function_prepare(i, thiz))
+	{
+		ENDER_ATOMIC_ADD(&thiz->errors, 1);
+		return EINA_FALSE;
+	}
+
+	start = _ender_item_function_time_get();
+	ender_call_invoke(thiz->call, args, retval);
+	t = _ender_item_function_time_get() - start;
+
+	ENDER_ATOMIC_ADD(&thiz->total_time, t);
+	max = ENDER_ATOMIC_GET(&thiz->max_time);
+	while (t > max && !ENDER_ATOMIC_CAS(&thiz->max_time, max, t))
+		max = ENDER_ATOMIC_GET(&thiz->max_time);
+	/* check if the function has thrown */
+	if (thiz->call->throw_position >= 0)
+	{
+		Eina_Error *err = args[thiz->call->throw_position].ptr;
+		if (err && *err)
+			ENDER_ATOMIC_ADD(&thiz->errors, 1);
+	}
+	return EINA_TRUE;
 }
 
 /*----------------------------------------------------------------------------*
@@ -153,6 +542,12 @@ static void _ender_item_function_deinit(Ender_Item *i)
 	Ender_Item_Function *thiz;
 
 	thiz = ENDER_ITEM_FUNCTION(i);
+	_ender_item_function_unprepare(thiz);
+	/* the cached args are immortal, they must be destroyed explicitly */
+	if (thiz->self)
+		ender_item_free(thiz->self);
+	if (thiz->ctor_ret)
+		ender_item_free(thiz->ctor_ret);
 	if (thiz->ret)
 	{
 		ender_item_parent_set(thiz->ret, NULL);
@@ -165,6 +560,7 @@ static void _ender_item_function_deinit(Ender_Item *i)
 	}
 	if (thiz->symname)
 		free(thiz->symname);
+	eina_lock_free(&thiz->closures_lock);
 	free(thiz);
 }
 
@@ -181,6 +577,7 @@ Ender_Item * ender_item_function_new(void)
 	Ender_Item_Function *thiz;
 
 	thiz = calloc(1, sizeof(Ender_Item_Function));
+	eina_lock_new(&thiz->closures_lock);
 	i = ender_item_new(&_descriptor, thiz);
 	return i;
 }
@@ -211,6 +608,7 @@ void ender_item_function_ret_set(Ender_Item *i, Ender_Item *arg)
 		return;
 	}
 	thiz = ENDER_ITEM_FUNCTION(i);
+	_ender_item_function_unprepare(thiz);
 	thiz->ret = arg;
 	ender_item_parent_set(arg, i);
 }
@@ -240,6 +638,7 @@ void ender_item_function_arg_add(Ender_Item *i, Ender_Item *arg)
 		thiz->flags |= ENDER_ITEM_FUNCTION_FLAG_THROWS;
 	}
 	ender_item_unref(arg_type);
+	_ender_item_function_unprepare(thiz);
 	thiz->args = eina_list_append(thiz->args, arg);
 	ender_item_parent_set(arg, i);
 }
@@ -249,8 +648,53 @@ void ender_item_function_flags_set(Ender_Item *i, int flags)
 	Ender_Item_Function *thiz;
 
 	thiz = ENDER_ITEM_FUNCTION(i);
+	_ender_item_function_unprepare(thiz);
 	thiz->flags = flags;
 }
+
+const char * ender_item_function_symname_get(Ender_Item *i)
+{
+	Ender_Item_Function *thiz;
+
+	thiz = ENDER_ITEM_FUNCTION(i);
+	return thiz->symname;
+}
+
+void ender_item_function_profile_enable(Eina_Bool enable)
+{
+	ENDER_ATOMIC_SET(&_profile, enable);
+}
+
+Eina_Bool ender_item_function_profile_get(Ender_Item *i,
+		unsigned long long *calls, unsigned long long *errors,
+		uint64_t *total_time, uint64_t *max_time)
+{
+	Ender_Item_Function *thiz;
+
+	thiz = ENDER_ITEM_FUNCTION(i);
+	if (!ENDER_ATOMIC_GET(&thiz->calls))
+		return EINA_FALSE;
+	if (calls) *calls = ENDER_ATOMIC_GET(&thiz->calls);
+	if (errors) *errors = ENDER_ATOMIC_GET(&thiz->errors);
+	if (total_time) *total_time = ENDER_ATOMIC_GET(&thiz->total_time);
+	if (max_time) *max_time = ENDER_ATOMIC_GET(&thiz->max_time);
+	return EINA_TRUE;
+}
+
+/* Load the symbol of a function and optionally build its call interface.
+ * The callbacks do not have a symbol, so nothing is done for them
+ */
+Eina_Bool ender_item_function_sym_load(Ender_Item *i, Eina_Bool prepare)
+{
+	Ender_Item_Function *thiz;
+
+	thiz = ENDER_ITEM_FUNCTION(i);
+	if (thiz->flags & ENDER_ITEM_FUNCTION_FLAG_CALLBACK)
+		return EINA_TRUE;
+	if (prepare)
+		return ENDER_ATOMIC_GET(&thiz->call) || _ender_item_function_prepare(i, thiz);
+	return _ender_item_function_sym_load(i, thiz);
+}
 /*============================================================================*
  *                                   API                                      *
  *============================================================================*/
@@ -295,12 +739,8 @@ EAPI Eina_List * ender_item_function_args_get(Ender_Item *i)
 	thiz = ENDER_ITEM_FUNCTION(i);
 	if (thiz->flags & ENDER_ITEM_FUNCTION_FLAG_IS_METHOD)
 	{
-		Ender_Item *arg;
-
-		arg = ender_item_arg_new();
-		ender_item_name_set(arg, "self");
-		ender_item_arg_type_set(arg, ender_item_parent_get(i));
-		ret = eina_list_append(ret, arg);
+		ret = eina_list_append(ret, _ender_item_function_self_get(i,
+				thiz));
 	}
 
 	EINA_LIST_FOREACH(thiz->args, l, i)
@@ -326,12 +766,7 @@ EAPI Ender_Item * ender_item_function_args_at(Ender_Item *i, int idx)
 	{
 		if (!idx)
 		{
-			Ender_Item *arg;
-
-			arg = ender_item_arg_new();
-			ender_item_name_set(arg, "self");
-			ender_item_arg_type_set(arg, ender_item_parent_get(i));
-			return arg;
+			return _ender_item_function_self_get(i, thiz);
 		}
 		else
 		{
@@ -384,14 +819,9 @@ EAPI Ender_Item * ender_item_function_ret_get(Ender_Item *i)
 	thiz = ENDER_ITEM_FUNCTION(i);
 	if (thiz->flags & ENDER_ITEM_FUNCTION_FLAG_CTOR)
 	{
-		Ender_Item *ret;
-
 		/* create our own arg based on the parent type */
-		ret = ender_item_arg_new();
-		ender_item_arg_direction_set(ret, ENDER_ITEM_ARG_DIRECTION_IN);
-		ender_item_arg_transfer_set(ret, ENDER_ITEM_TRANSFER_FULL);
-		ender_item_arg_type_set(ret, ender_item_parent_get(i));
-		return ret;
+		return _ender_item_function_parent_arg_get(i, &thiz->ctor_ret,
+				NULL);
 	}
 	else
 	{
@@ -409,83 +839,321 @@ EAPI Ender_Item * ender_item_function_ret_get(Ender_Item *i)
 EAPI Eina_Bool ender_item_function_call(Ender_Item *i, Ender_Value *args, Ender_Value *retval)
 {
 	Ender_Item_Function *thiz;
-	Ender_Item *a;
-	Ender_Item *i_ret;
-	Eina_List *l;
-	ffi_type **ffi_args;
-	ffi_type *ffi_ret = &ffi_type_void;
-	ffi_status status;
-	ffi_cif cif;
-	void **ffi_values;
-	int ffi_arg = 0;
-	int arg = 0;
-	int nargs;
 
 	thiz = ENDER_ITEM_FUNCTION(i);
+	if (EINA_UNLIKELY(ENDER_ATOMIC_GET(&_profile)))
+		return _ender_item_function_call_profile(i, thiz, args, retval);
+
+	if (!ENDER_ATOMIC_GET(&thiz->call) && !_ender_item_function_prepare(i, thiz))
+		return EINA_FALSE;
+
+	ender_call_invoke(thiz->call, args, retval);
+	return EINA_TRUE;
+}
+
+/**
+ * Call a function several times
+ *
+ * Calls the same function once per row of arguments. The symbol resolution,
+ * the call interface and the arguments validation are done only once for
+ * the whole batch.
+ *
+ * @param i The function to call
+ * @param args The array of values of every row. Each row must have the
+ * values that match the number of arguments
+ * @param stride The number of values between the start of two consecutive
+ * rows on @a args. It must be greater or equal than the number of arguments
+ * @param rows The number of rows, i.e the number of times the function will
+ * be called
+ * @param rets The array of returning values, one per row. Can be NULL in
+ * case the function does not return anything or the value is not needed
+ * @return EINA_TRUE if the call is succesful, EINA_FALSE otherwise
+ */
+EAPI Eina_Bool ender_item_function_call_batch(Ender_Item *i,
+		const Ender_Value *args, size_t stride, size_t rows,
+		Ender_Value *rets)
+{
+	Ender_Item_Function *thiz;
+	Ender_Value *row;
+	size_t r;
+
+	thiz = ENDER_ITEM_FUNCTION(i);
+	if (!ENDER_ATOMIC_GET(&thiz->call) && !_ender_item_function_prepare(i, thiz))
+		return EINA_FALSE;
 
-	/* load the symbol */
-	if (!thiz->sym)
+	if (stride < (size_t)thiz->call->nargs)
 	{
-		DBG("Loading symbol '%s'", thiz->symname);
-		thiz->sym = ender_item_sym_get(i, thiz->symname);
+		ERR("Stride %zu is smaller than the number of arguments %d",
+				stride, thiz->call->nargs);
+		return EINA_FALSE;
 	}
-	if (!thiz->sym)
+
+	/* the values are never written, only passed by reference */
+	row = (Ender_Value *)args;
+	for (r = 0; r < rows; r++, row += stride)
 	{
-		CRI("Impossible to load the symbol '%s'", thiz->symname);
-		return EINA_FALSE;
+		ender_call_invoke(thiz->call, row, rets ? &rets[r] : NULL);
 	}
+	return EINA_TRUE;
+}
 
-	/* pass the args as ffi args */
-	nargs = eina_list_count(thiz->args);
-	if (thiz->flags & ENDER_ITEM_FUNCTION_FLAG_IS_METHOD)
-		nargs++;
+/**
+ * Prepare a call to a function
+ *
+ * Resolves the symbol and builds the call interface of the function once, so
+ * it can be called repeatedly through @ref ender_call_invoke without any
+ * lookup on the function description. This is useful for bindings that
+ * want to cache the calls of the methods they wrap.
+ *
+ * @param i The function to prepare the call for
+ * @return The prepared call or NULL in case the function can not be called.
+ * Use @ref ender_call_free to free it
+ */
+EAPI Ender_Call * ender_item_function_call_prepare(Ender_Item *i)
+{
+	Ender_Item_Function *thiz;
+	Ender_Call *call;
 
-	ffi_args = calloc(nargs, sizeof(ffi_type *));
-	ffi_values = calloc(nargs, sizeof(void *));
+	if (!i) return NULL;
 
-	/* fill in the args */
-	if (thiz->flags & ENDER_ITEM_FUNCTION_FLAG_IS_METHOD)
+	thiz = ENDER_ITEM_FUNCTION(i);
+	if (!ENDER_ATOMIC_GET(&thiz->call) && !_ender_item_function_prepare(i, thiz))
+		return NULL;
+
+	call = _ender_call_dup(thiz->call);
+	call->item = ender_item_ref(i);
+	ender_lib_calls_add(ender_item_lib_get(i), 1);
+
+	return call;
+}
+
+/**
+ * Invoke a prepared call
+ *
+ * No validation is done on the call, the args must match the number of
+ * arguments of the call, including the instance in case the function is a
+ * method.
+ *
+ * @param call The call to invoke
+ * @param args The array of values that matches the number of arguments
+ * @param retval The returning value of the function call
+ */
+EAPI void ender_call_invoke(const Ender_Call *call, Ender_Value *args,
+		Ender_Value *retval)
+{
+	void *ffi_values[call->nargs + 1];
+	int arg;
+
+	if (call->thunk)
 	{
-		ffi_args[ffi_arg] = &ffi_type_pointer;
-		ffi_values[ffi_arg] = &args[arg];
-		arg++;
-		ffi_arg++;
+		call->thunk(call->sym, args, retval);
+		return;
 	}
 
-	EINA_LIST_FOREACH(thiz->args, l, a)
+	/* every ender value is passed by reference, the structs passed by value
+	 * already are a reference
+	 */
+	for (arg = 0; arg < call->nargs; arg++)
 	{
-		Ender_Item *type;
-
-		type = ender_item_arg_type_get(a);
-		ffi_args[ffi_arg] = _ender_item_function_arg_ffi_to(type);
-		ffi_values[ffi_arg] = &args[arg];
-		arg++;
-		ffi_arg++;
-		ender_item_unref(type);
+		if (call->ffi_args[arg]->type == FFI_TYPE_STRUCT)
+			ffi_values[arg] = args[arg].ptr;
+		else
+			ffi_values[arg] = &args[arg];
 	}
+	if (retval && call->cif.rtype->type == FFI_TYPE_STRUCT)
+		ffi_call((ffi_cif *)&call->cif, FFI_FN(call->sym), retval->ptr,
+				ffi_values);
+	else
+		ffi_call((ffi_cif *)&call->cif, FFI_FN(call->sym), retval,
+				ffi_values);
+}
+
+/**
+ * Get the number of arguments of a prepared call
+ *
+ * The count includes the instance argument in case the function is a method
+ * @param call The call to get the number of arguments from
+ * @return The number of arguments
+ */
+EAPI int ender_call_args_count(const Ender_Call *call)
+{
+	return call->nargs;
+}
 
-	i_ret = ender_item_function_ret_get(i);
-	if (i_ret)
+/**
+ * Get the index position of the argument that is used for exceptions
+ * @param call The call to get the position index from
+ * @return The position index of the argument or -1 in case the function
+ * does not throw
+ * @see ender_item_function_throw_position_get
+ */
+EAPI int ender_call_throw_position_get(const Ender_Call *call)
+{
+	return call->throw_position;
+}
+
+/**
+ * Get the function a call has been prepared from
+ * @param call The call to get the function from
+ * @return The function. @ender_transfer{none}
+ */
+EAPI Ender_Item * ender_call_item_get(const Ender_Call *call)
+{
+	return ender_item_ref(call->item);
+}
+
+/**
+ * Free a prepared call
+ * @param call The call to free
+ */
+EAPI void ender_call_free(Ender_Call *call)
+{
+	if (!call) return;
+	ender_lib_calls_add(ender_item_lib_get(call->item), -1);
+	ender_item_unref(call->item);
+	_ender_call_free(call);
+}
+
+
+/**
+ * Create a closure for a callback
+ *
+ * A closure is a C function pointer with the prototype of the callback that
+ * forwards every call to @a cb. The closures are taken from a pool on the
+ * callback, so creating and freeing them repeatedly does not need to create
+ * a new trampoline every time.
+ *
+ * @param i The callback to create the closure for
+ * @param cb The function to call whenever the closure is called
+ * @param data The user provided data passed to @a cb
+ * @return The closure or NULL in case of error. Use @ref ender_closure_free
+ * once the C side no longer uses it
+ */
+EAPI Ender_Closure * ender_item_function_closure_new(Ender_Item *i,
+		Ender_Closure_Cb cb, void *data)
+{
+	Ender_Item_Function *thiz;
+	Ender_Closure *closure;
+	Ender_Call *call;
+
+	if (!i) return NULL;
+
+	thiz = ENDER_ITEM_FUNCTION(i);
+	if (!(thiz->flags & ENDER_ITEM_FUNCTION_FLAG_CALLBACK))
 	{
-		Ender_Item *type;
+		ERR("Function '%s' is not a callback", ender_item_name_get(i));
+		return NULL;
+	}
 
-		type = ender_item_arg_type_get(i_ret);
-		ffi_ret = _ender_item_function_arg_ffi_to(type);
-		ender_item_unref(type);
-		ender_item_unref(i_ret);
+	call = ENDER_ATOMIC_GET(&thiz->closure_call);
+	if (!call)
+	{
+		call = _ender_item_function_call_new(i, thiz, NULL);
+		if (!call)
+			return NULL;
+		/* another thread might have created it meanwhile */
+		if (!ENDER_ATOMIC_CAS(&thiz->closure_call, NULL, call))
+		{
+			_ender_call_free(call);
+			call = ENDER_ATOMIC_GET(&thiz->closure_call);
+		}
 	}
 
-	if ((status = ffi_prep_cif(&cif, FFI_DEFAULT_ABI, nargs, ffi_ret,
-			ffi_args)) != FFI_OK)
+	eina_lock_take(&thiz->closures_lock);
+	if (thiz->closures)
 	{
-		/* TODO handle the ffi_status */
-		ERR("FFI error");
+		closure = eina_list_data_get(thiz->closures);
+		thiz->closures = eina_list_remove_list(thiz->closures,
+				thiz->closures);
+		ENDER_ATOMIC_ADD(&_closures_pooled, -1);
+	}
+	else
+	{
+		closure = calloc(1, sizeof(Ender_Closure));
+		closure->closure = ffi_closure_alloc(sizeof(ffi_closure),
+				&closure->code);
+		if (!closure->closure)
+		{
+			eina_lock_release(&thiz->closures_lock);
+			ERR("Impossible to allocate a closure for '%s'",
+					ender_item_name_get(i));
+			free(closure);
+			return NULL;
+		}
+		/* the closure is bound to the same data for its whole life */
+		if (ffi_prep_closure_loc(closure->closure, &call->cif,
+				_ender_closure_dispatch, closure,
+				closure->code) != FFI_OK)
+		{
+			eina_lock_release(&thiz->closures_lock);
+			ERR("Impossible to prepare a closure for '%s'",
+					ender_item_name_get(i));
+			ffi_closure_free(closure->closure);
+			free(closure);
+			return NULL;
+		}
 	}
+	thiz->closures_live++;
+	eina_lock_release(&thiz->closures_lock);
 
-	ffi_call(&cif, FFI_FN(thiz->sym), retval, ffi_values);
-	free(ffi_args);
-	free(ffi_values);
+	closure->item = ender_item_ref(i);
+	closure->cb = cb;
+	closure->data = data;
+	ENDER_ATOMIC_ADD(&_closures_live, 1);
+	ender_lib_calls_add(ender_item_lib_get(i), 1);
 
-	return EINA_TRUE;
+	return closure;
 }
 
+/**
+ * Get the function pointer of a closure
+ *
+ * This is the value that must be passed on a callback argument
+ * @param closure The closure to get the function pointer from
+ * @return The function pointer
+ */
+EAPI void * ender_closure_code_get(const Ender_Closure *closure)
+{
+	return closure->code;
+}
+
+/**
+ * Free a closure
+ *
+ * The closure is given back to the pool of its callback, so it must not be
+ * called anymore from the C side.
+ * @param closure The closure to free
+ */
+EAPI void ender_closure_free(Ender_Closure *closure)
+{
+	Ender_Item_Function *thiz;
+	Ender_Item *i;
+
+	if (!closure) return;
+
+	i = closure->item;
+	thiz = ENDER_ITEM_FUNCTION(i);
+	closure->item = NULL;
+	closure->cb = NULL;
+	closure->data = NULL;
+	eina_lock_take(&thiz->closures_lock);
+	thiz->closures = eina_list_prepend(thiz->closures, closure);
+	thiz->closures_live--;
+	eina_lock_release(&thiz->closures_lock);
+	ENDER_ATOMIC_ADD(&_closures_live, -1);
+	ENDER_ATOMIC_ADD(&_closures_pooled, 1);
+	ender_lib_calls_add(ender_item_lib_get(i), -1);
+	/* in case this is the last reference, the pool is freed too */
+	ender_item_unref(i);
+}
+
+/**
+ * Get the closure counters
+ * @param live The number of closures in use
+ * @param pooled The number of closures ready to be reused
+ */
+EAPI void ender_closure_counters_get(int *live, int *pooled)
+{
+	if (live) *live = ENDER_ATOMIC_GET(&_closures_live);
+	if (pooled) *pooled = ENDER_ATOMIC_GET(&_closures_pooled);
+}
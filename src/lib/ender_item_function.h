@@ -75,14 +75,53 @@ typedef enum _Ender_Item_Function_Flag
 	ENDER_ITEM_FUNCTION_FLAG_DOWNCAST  = (1 << 1),
 } Ender_Item_Function_Flag;
 
+/**
+ * @brief Prepared call handle
+ * @see ender_item_function_call_prepare
+ */
+typedef struct _Ender_Call Ender_Call;
+
+/**
+ * @brief C function pointer that forwards the calls of a callback
+ * @see ender_item_function_closure_new
+ */
+typedef struct _Ender_Closure Ender_Closure;
+
+/**
+ * Function called whenever a closure is called from the C side
+ * @param i The callback the closure implements
+ * @param args The values of the arguments
+ * @param retval The value to return
+ * @param data The user provided data
+ */
+typedef void (*Ender_Closure_Cb)(Ender_Item *i, Ender_Value *args,
+		Ender_Value *retval, void *data);
+
 EAPI Eina_List * ender_item_function_args_get(Ender_Item *i);
 EAPI Ender_Item * ender_item_function_args_at(Ender_Item *i, int idx);
 EAPI int ender_item_function_args_count(Ender_Item *i);
 EAPI Ender_Item * ender_item_function_ret_get(Ender_Item *i);
-Eina_Bool ender_item_function_call(Ender_Item *i,
+EAPI Eina_Bool ender_item_function_call(Ender_Item *i,
 		Ender_Value *args, Ender_Value *retval);
+EAPI Eina_Bool ender_item_function_call_batch(Ender_Item *i,
+		const Ender_Value *args, size_t stride, size_t rows,
+		Ender_Value *rets);
 EAPI int ender_item_function_flags_get(Ender_Item *i);
 EAPI int ender_item_function_throw_position_get(Ender_Item *i);
+EAPI Ender_Call * ender_item_function_call_prepare(Ender_Item *i);
+
+EAPI void ender_call_invoke(const Ender_Call *call, Ender_Value *args,
+		Ender_Value *retval);
+EAPI int ender_call_args_count(const Ender_Call *call);
+EAPI int ender_call_throw_position_get(const Ender_Call *call);
+EAPI Ender_Item * ender_call_item_get(const Ender_Call *call);
+EAPI void ender_call_free(Ender_Call *call);
+
+EAPI Ender_Closure * ender_item_function_closure_new(Ender_Item *i,
+		Ender_Closure_Cb cb, void *data);
+EAPI void * ender_closure_code_get(const Ender_Closure *closure);
+EAPI void ender_closure_free(Ender_Closure *closure);
+EAPI void ender_closure_counters_get(int *live, int *pooled);
 
 /**
  * @}
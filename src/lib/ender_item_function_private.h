@@ -26,6 +26,12 @@ void ender_item_function_symname_set(Ender_Item *i, const char *symname);
 void ender_item_function_arg_add(Ender_Item *i, Ender_Item *arg);
 void ender_item_function_flags_set(Ender_Item *i, int flags);
 void ender_item_function_ret_set(Ender_Item *i, Ender_Item *ret);
+const char * ender_item_function_symname_get(Ender_Item *i);
+Eina_Bool ender_item_function_sym_load(Ender_Item *i, Eina_Bool prepare);
+void ender_item_function_profile_enable(Eina_Bool enable);
+Eina_Bool ender_item_function_profile_get(Ender_Item *i,
+		unsigned long long *calls, unsigned long long *errors,
+		uint64_t *total_time, uint64_t *max_time);
 
 #endif
 
@@ -30,9 +30,11 @@ typedef struct _Ender_Item
 	void *data;
 	Ender_Item *parent;
 	Ender_Item_Type type;
-	char *name;
+	/* shared string */
+	const char *name;
 	int ref;
-	int cycle_ref;
+	/* owned by a lib, it lives as long as the lib */
+	Eina_Bool immortal;
 } Ender_Item;
 
 typedef void (*Ender_Item_Descriptor_Init)(Ender_Item *thiz);
@@ -44,6 +46,9 @@ struct _Ender_Item_Descriptor
 	Ender_Item_Descriptor_Deinit deinit;
 };
 
+void ender_item_init(void);
+void ender_item_shutdown(void);
+
 Ender_Item * ender_item_new(Ender_Item_Descriptor *desc, void *data);
 void * ender_item_data_get(Ender_Item *thiz);
 
@@ -51,6 +56,9 @@ void ender_item_name_set(Ender_Item *thiz, const char *name);
 void ender_item_parent_set(Ender_Item *thiz, Ender_Item *parent);
 void * ender_item_sym_get(Ender_Item *thiz, const char *name);
 int ender_item_ref_count(Ender_Item *thiz);
-void ender_item_cycle_ref_set(Ender_Item *thiz, int ref);
+void ender_item_immortal_set(Ender_Item *thiz);
+Eina_Bool ender_item_immortal_get(Ender_Item *thiz);
+void ender_item_deinit(Ender_Item *thiz);
+void ender_item_free(Ender_Item *thiz);
 
 #endif
@@ -33,14 +33,58 @@
  *                                  Local                                     *
  *============================================================================*/
 #define ENDER_ITEM_STRUCT(o) (Ender_Item_Struct *)(ender_item_data_get(o))
+/* max number of released instances kept on the pool of every struct */
+#define ENDER_ITEM_STRUCT_POOL_MAX 16
 
 typedef struct _Ender_Item_Struct
 {
 	Eina_List *fields;
 	Eina_List *functions;
 	size_t size;
+	/* the ffi type to pass the struct by value, built on demand */
+	ffi_type *ffi;
+	/* released instances ready to be reused */
+	Eina_Trash *pool;
+	Eina_Lock pool_lock;
+	int pooled;
 } Ender_Item_Struct;
 
+/* Every instance is preceded by the size it was allocated with. The layout
+ * of a struct might change while its instances are alive, a released
+ * instance smaller than the current layout is not kept on the pool
+ */
+typedef union _Ender_Item_Struct_Instance
+{
+	size_t size;
+	/* keep the instance aligned for any field */
+	long double ld;
+	void *ptr;
+	uint64_t u64;
+} Ender_Item_Struct_Instance;
+
+#define ENDER_ITEM_STRUCT_INSTANCE(instance) \
+	(((Ender_Item_Struct_Instance *)(instance)) - 1)
+
+static void _ender_item_struct_ffi_free(Ender_Item_Struct *thiz)
+{
+	if (!thiz->ffi)
+		return;
+	free(thiz->ffi->elements);
+	free(thiz->ffi);
+	thiz->ffi = NULL;
+}
+
+static void _ender_item_struct_pool_free(Ender_Item_Struct *thiz)
+{
+	void *instance;
+
+	eina_lock_take(&thiz->pool_lock);
+	EINA_TRASH_CLEAN(&thiz->pool, instance)
+		free(ENDER_ITEM_STRUCT_INSTANCE(instance));
+	thiz->pooled = 0;
+	eina_lock_release(&thiz->pool_lock);
+}
+
 /*----------------------------------------------------------------------------*
  *                             Item descriptor                                *
  *----------------------------------------------------------------------------*/
@@ -64,6 +108,9 @@ static void _ender_item_struct_deinit(Ender_Item *i)
 		ender_item_parent_set(i, NULL);
 		ender_item_unref(i);
 	}
+	_ender_item_struct_ffi_free(thiz);
+	_ender_item_struct_pool_free(thiz);
+	eina_lock_free(&thiz->pool_lock);
 	free(thiz);
 }
 
@@ -99,6 +146,32 @@ static Eina_Bool _ender_item_field_size_alignment_get(Ender_Item *i, size_t *sz,
 	}
 	return ret;
 }
+
+static ffi_type * _ender_item_field_ffi_type_get(Ender_Item *i)
+{
+	Ender_Item_Type type;
+	Ender_Item *other;
+	ffi_type *ret = NULL;
+
+	type = ender_item_type_get(i);
+	switch (type)
+	{
+		case ENDER_ITEM_TYPE_BASIC:
+		ret = ender_value_type_ffi_to(ender_item_basic_value_type_get(i));
+		break;
+
+		case ENDER_ITEM_TYPE_DEF:
+		other = ender_item_def_type_get(i);
+		ret = _ender_item_field_ffi_type_get(other);
+		ender_item_unref(other);
+		break;
+
+		default:
+		CRI("Unsupported attr type '%d'", type);
+		break;
+	}
+	return ret;
+}
 /*============================================================================*
  *                                 Global                                     *
  *============================================================================*/
@@ -108,6 +181,7 @@ Ender_Item * ender_item_struct_new(void)
 	Ender_Item_Struct *thiz;
 
 	thiz = calloc(1, sizeof(Ender_Item_Struct));
+	eina_lock_new(&thiz->pool_lock);
 	i = ender_item_new(&_descriptor, thiz);
 	return i;
 }
@@ -128,6 +202,9 @@ void ender_item_struct_field_add(Ender_Item *i, Ender_Item *p)
 	}
 		
 	thiz = ENDER_ITEM_STRUCT(i);
+	/* the layout changes, the instances already created are too small */
+	_ender_item_struct_ffi_free(thiz);
+	_ender_item_struct_pool_free(thiz);
 	attr_type = ender_item_attr_type_get(p);
 	if (!_ender_item_field_size_alignment_get(attr_type, &size, &align))
 	{
@@ -146,6 +223,98 @@ void ender_item_struct_field_add(Ender_Item *i, Ender_Item *p)
 	ender_item_parent_set(p, i);
 }
 
+/* Add a field with an already known offset, the size of the struct must be
+ * set with ender_item_struct_size_set() once every field is added
+ */
+void ender_item_struct_field_offset_add(Ender_Item *i, Ender_Item *p,
+		ssize_t offset)
+{
+	Ender_Item_Struct *thiz;
+
+	if (ender_item_type_get(p) != ENDER_ITEM_TYPE_ATTR)
+	{
+		ender_item_unref(p);
+		return;
+	}
+
+	thiz = ENDER_ITEM_STRUCT(i);
+	_ender_item_struct_ffi_free(thiz);
+	_ender_item_struct_pool_free(thiz);
+	ender_item_attr_offset_set(p, offset);
+	thiz->fields = eina_list_append(thiz->fields, p);
+	ender_item_parent_set(p, i);
+}
+
+void ender_item_struct_size_set(Ender_Item *i, size_t size)
+{
+	Ender_Item_Struct *thiz;
+
+	thiz = ENDER_ITEM_STRUCT(i);
+	/* the layout changes, the instances already created might be too small */
+	_ender_item_struct_pool_free(thiz);
+	thiz->size = size;
+}
+
+/* Get the size of a field of the given type */
+Eina_Bool ender_item_struct_field_size_get(Ender_Item *type, size_t *size)
+{
+	ssize_t align;
+
+	return _ender_item_field_size_alignment_get(type, size, &align);
+}
+
+/* Get the ffi type of the struct based on the fields layout. The type is built
+ * only once and owned by the struct. In case two threads build it at the same
+ * time, the first one published is kept
+ */
+ffi_type * ender_item_struct_ffi_type_get(Ender_Item *i)
+{
+	Ender_Item_Struct *thiz;
+	Ender_Item *f;
+	Eina_List *l;
+	ffi_type *ffi;
+	int n = 0;
+
+	thiz = ENDER_ITEM_STRUCT(i);
+	ffi = ENDER_ATOMIC_GET(&thiz->ffi);
+	if (ffi)
+		return ffi;
+
+	if (!thiz->fields)
+	{
+		ERR("The struct '%s' has no fields", ender_item_name_get(i));
+		return NULL;
+	}
+
+	ffi = calloc(1, sizeof(ffi_type));
+	ffi->type = FFI_TYPE_STRUCT;
+	ffi->elements = calloc(eina_list_count(thiz->fields) + 1,
+			sizeof(ffi_type *));
+	EINA_LIST_FOREACH(thiz->fields, l, f)
+	{
+		Ender_Item *type;
+
+		type = ender_item_attr_type_get(f);
+		ffi->elements[n] = _ender_item_field_ffi_type_get(type);
+		ender_item_unref(type);
+		if (!ffi->elements[n])
+		{
+			free(ffi->elements);
+			free(ffi);
+			return NULL;
+		}
+		n++;
+	}
+	/* the size and alignment are filled by libffi when preparing a cif */
+	if (!ENDER_ATOMIC_CAS(&thiz->ffi, NULL, ffi))
+	{
+		free(ffi->elements);
+		free(ffi);
+		return ENDER_ATOMIC_GET(&thiz->ffi);
+	}
+	return ffi;
+}
+
 Eina_Bool ender_item_struct_field_value_get(void *o, Ender_Item *field,
 		Ender_Value *v, Eina_Error *err)
 {
@@ -367,3 +536,78 @@ EAPI Eina_List * ender_item_struct_functions_get(Ender_Item *i)
 	return ret;
 }
 
+/**
+ * Create a new instance of a struct
+ *
+ * Instances previously released with @ref ender_item_struct_instance_free
+ * are reused, so creating and releasing instances on a loop does not hit
+ * the allocator.
+ * @param i The struct to create the instance from
+ * @return A zero filled instance of the struct. Use
+ * @ref ender_item_struct_instance_free to release it, never free()
+ */
+EAPI void * ender_item_struct_instance_new(Ender_Item *i)
+{
+	Ender_Item_Struct *thiz;
+	Ender_Item_Struct_Instance *header;
+	size_t size;
+	void *ret;
+
+	thiz = ENDER_ITEM_STRUCT(i);
+	size = thiz->size;
+	eina_lock_take(&thiz->pool_lock);
+	ret = eina_trash_pop(&thiz->pool);
+	if (ret)
+		thiz->pooled--;
+	eina_lock_release(&thiz->pool_lock);
+	if (ret)
+	{
+		header = ENDER_ITEM_STRUCT_INSTANCE(ret);
+		if (header->size >= size)
+		{
+			memset(ret, 0, size);
+			return ret;
+		}
+		free(header);
+	}
+	/* the pool reuses the instance memory to link the released ones */
+	if (size < sizeof(Eina_Trash))
+		size = sizeof(Eina_Trash);
+	header = calloc(1, sizeof(Ender_Item_Struct_Instance) + size);
+	if (!header)
+		return NULL;
+	header->size = size;
+	return header + 1;
+}
+
+/**
+ * Release an instance of a struct
+ *
+ * The instance is kept on the struct pool for later use. Only the memory
+ * of the instance is released, the fields pointed by it are not.
+ * @param i The struct the instance was created from
+ * @param instance The instance to release
+ */
+EAPI void ender_item_struct_instance_free(Ender_Item *i, void *instance)
+{
+	Ender_Item_Struct *thiz;
+
+	if (!instance) return;
+	thiz = ENDER_ITEM_STRUCT(i);
+	/* an instance created before a layout change is not reused */
+	if (ENDER_ITEM_STRUCT_INSTANCE(instance)->size < thiz->size)
+	{
+		free(ENDER_ITEM_STRUCT_INSTANCE(instance));
+		return;
+	}
+	eina_lock_take(&thiz->pool_lock);
+	if (thiz->pooled < ENDER_ITEM_STRUCT_POOL_MAX)
+	{
+		eina_trash_push(&thiz->pool, instance);
+		thiz->pooled++;
+		instance = NULL;
+	}
+	eina_lock_release(&thiz->pool_lock);
+	if (instance)
+		free(ENDER_ITEM_STRUCT_INSTANCE(instance));
+}
@@ -28,6 +28,8 @@
 EAPI size_t ender_item_struct_size_get(Ender_Item *i);
 EAPI Eina_List * ender_item_struct_fields_get(Ender_Item *i);
 EAPI Eina_List * ender_item_struct_functions_get(Ender_Item *i);
+EAPI void * ender_item_struct_instance_new(Ender_Item *i);
+EAPI void ender_item_struct_instance_free(Ender_Item *i, void *instance);
 
 /**
  * @}
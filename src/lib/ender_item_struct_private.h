@@ -23,6 +23,11 @@
 
 Ender_Item * ender_item_struct_new(void);
 void ender_item_struct_field_add(Ender_Item *i, Ender_Item *f);
+void ender_item_struct_field_offset_add(Ender_Item *i, Ender_Item *f,
+		ssize_t offset);
+void ender_item_struct_size_set(Ender_Item *i, size_t size);
+ffi_type * ender_item_struct_ffi_type_get(Ender_Item *i);
+Eina_Bool ender_item_struct_field_size_get(Ender_Item *type, size_t *size);
 
 Eina_Bool ender_item_struct_field_value_set(void *o, Ender_Item *field,
 		Ender_Value *v, Eina_Error *err);
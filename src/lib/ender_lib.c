@@ -23,60 +23,896 @@
 #include "ender_value.h"
 #include "ender_parser.h"
 
+#include "ender_item_function.h"
+#include "ender_item_attr.h"
+#include "ender_item_object.h"
+#include "ender_item_struct.h"
+#include "ender_item_def.h"
+
 #include "ender_main_private.h"
 #include "ender_lib_private.h"
+#include "ender_parser_private.h"
+#include "ender_cache_private.h"
 #include "ender_item_private.h"
 #include "ender_item_basic_private.h"
+#include "ender_item_function_private.h"
+#include "ender_item_attr_private.h"
 /*============================================================================*
  *                                  Local                                     *
  *============================================================================*/
 /** @cond internal */
 struct _Ender_Lib
 {
+	/* the deps, items and resolved tables of a registered lib are only
+	 * replaced when reloading it, the old ones are retired
+	 */
 	Eina_List *deps;
 	Eina_Hash *items;
+	/* every item created for the lib, including the children of the items */
+	Eina_List *owned;
+	/* the items visible from the lib, built once the lib is complete */
+	Eina_Hash *resolved;
 	int version;
 	Ender_Case kase;
 	Ender_Notation notation;
-	char *name;
+	/* shared string */
+	const char *name;
 	char *file;
 	void *dl;
+	/* the symbols of a precompiled lib */
+	const Ender_Lib_Image *image;
+	/* the hash of the description or image the lib comes from */
+	uint32_t source_hash;
+	/* the prepared calls and closures of its functions */
+	int calls;
+	/* the libs being parsed that include it, not registered yet */
+	int pins;
+	/* the items created by its reloads, the replaced ones are kept */
+	unsigned int reloaded;
+	/* some of its items were added to the objects of other libs */
+	Eina_Bool extends;
+	/* its deps are pinned until it is registered or freed */
+	Eina_Bool pinning;
 };
 
-static Eina_Hash *_libraries = NULL;
+/* A description found on the descriptions dir or a precompiled image, it is
+ * parsed the first time its lib is requested
+ */
+typedef struct _Ender_Lib_Description
+{
+	char *name;
+	char *file;
+	const Ender_Lib_Image *image;
+	Eina_Bool parsed;
+	/* the descriptions that include this one and the number of included
+	 * descriptions not parsed yet, for the parallel loading
+	 */
+	Eina_List *dependents;
+	int pending;
+	/* it extends the objects of other libs, it is parsed sequentially */
+	Eina_Bool deferred;
+} Ender_Lib_Description;
+
+/* The eager loading parses the descriptions on several threads, a description
+ * is ready to be parsed once all the descriptions it includes are registered.
+ * The threads do not lock the registry, so a description that extends the
+ * objects of another lib, and the ones that include it, are left for the
+ * sequential parsing once the threads are done
+ */
+typedef struct _Ender_Lib_Loader
+{
+	Eina_Lock lock;
+	Eina_Condition cond;
+	Eina_List *ready;
+	int running;
+} Ender_Lib_Loader;
+
+/* The registered libraries sorted by name. A table is never modified once
+ * published, every registration creates a new one, so the lookups can be done
+ * from any thread without locks. A replaced table might still be in use by a
+ * reader, so it is retired instead of freed, the same for the unloaded libs,
+ * as the lookups compare their names
+ */
+typedef struct _Ender_Lib_Table
+{
+	unsigned int count;
+	Ender_Lib *libs[];
+} Ender_Lib_Table;
+
+/* Something replaced while a lookup might still be using it */
+typedef struct _Ender_Lib_Retired
+{
+	void *data;
+	Eina_Free_Cb free_cb;
+} Ender_Lib_Retired;
+
+/* The items replaced by the reloads of a lib are kept until it is unloaded,
+ * a lib is not reloaded anymore once its reloads have created this many items
+ */
+#define ENDER_LIB_RELOADED_MAX 65536
+
+static Ender_Lib_Table *_libraries = NULL;
+/* Every lookup is counted on the epoch it starts on. What is retired during
+ * an epoch is freed once the lookups of the epoch before have finished, so
+ * the new lookups never delay the reclamation of what was retired before
+ * them. Only the counters of the current and the previous epoch are in use
+ */
+static unsigned int _epoch = 0;
+static int _readers[2] = { 0, 0 };
+static Eina_List *_retired[2] = { NULL, NULL };
+/* what other modules retire, moved to the current epoch on the next
+ * reclamation. Guarded by its own lock, the table lock might be taken or not
+ */
+static Eina_List *_retiring = NULL;
+static Eina_Lock _retire_lock;
 static Ender_Lib *_c_lib = NULL;
 static int _init = 0;
+/* the lock to load the libraries from any thread */
+static Eina_Lock _dl_lock;
+/* the lock to publish a new table of libraries */
+static Eina_Lock _table_lock;
+/* the lock to parse and register new libraries */
+static Eina_Lock _registry_lock;
+/* the descriptions by lib name, only modified on the init and when adding
+ * images
+ */
+static Eina_Hash *_descriptions = NULL;
+/* the background symbol resolution, the libs are resolved as they are
+ * registered
+ */
+static Eina_Thread _resolver;
+static Eina_Lock _resolver_lock;
+static Eina_Condition _resolver_cond;
+static Eina_Bool _resolver_running = EINA_FALSE;
+static Eina_List *_resolver_pending = NULL;
+static Ender_Lib *_resolver_current = NULL;
+/* dump the profile of every lib on shutdown */
+static Eina_Bool _profile_dump = EINA_FALSE;
 
-static void _ender_lib_dir_list_cb(const char *name, const char *path, void *data)
+static void _ender_lib_basic_add(Ender_Lib *thiz, const char *name,
+		Ender_Value_Type vtype)
+{
+	Ender_Item *i;
+
+	i = ender_item_basic_new();
+	ender_item_name_set(i, name);
+	ender_item_basic_value_type_set(i, vtype);
+	ender_lib_item_add(thiz, ender_item_ref(i));
+	ender_lib_item_own(thiz, i);
+}
+
+/* Release the data of the items of a lib. The items themselves are still
+ * valid, so the items of other libs that refer to them can be released too
+ */
+static void _ender_lib_items_deinit(Ender_Lib *thiz)
+{
+	Ender_Item *i;
+	Eina_List *l;
+
+	if (thiz->resolved)
+	{
+		eina_hash_free(thiz->resolved);
+		thiz->resolved = NULL;
+	}
+	if (thiz->items)
+	{
+		eina_hash_free(thiz->items);
+		thiz->items = NULL;
+	}
+	EINA_LIST_FOREACH(thiz->owned, l, i)
+		ender_item_deinit(i);
+}
+
+/* Let the deps of a lib being parsed be unloaded again */
+static void _ender_lib_deps_unpin(Ender_Lib *thiz)
+{
+	Ender_Lib *dep;
+	Eina_List *l;
+
+	if (!thiz->pinning) return;
+	EINA_LIST_FOREACH(thiz->deps, l, dep)
+		ENDER_ATOMIC_ADD(&dep->pins, -1);
+	thiz->pinning = EINA_FALSE;
+}
+
+/* Release everything but the name, which might still be compared by a lookup */
+static void _ender_lib_release(Ender_Lib *thiz)
+{
+	Ender_Item *i;
+
+	_ender_lib_items_deinit(thiz);
+	EINA_LIST_FREE(thiz->owned, i)
+		ender_item_free(i);
+	thiz->deps = eina_list_free(thiz->deps);
+}
+
+/* Call a function for the lib and every lib it depends on, directly or not.
+ * The closest libs are visited first and every lib is visited only once
+ */
+static void _ender_lib_deps_foreach(const Ender_Lib *thiz,
+		Eina_Bool (*cb)(const Ender_Lib *lib, void *data), void *data)
 {
-	FILE *f;
 	const Ender_Lib *lib;
-	char *file = NULL;
+	const Ender_Lib *dep;
+	Eina_List *queue;
+	Eina_List *visited;
+	Eina_List *l;
+
+	queue = eina_list_append(NULL, thiz);
+	visited = eina_list_append(NULL, thiz);
+	while (queue)
+	{
+		lib = eina_list_data_get(queue);
+		queue = eina_list_remove_list(queue, queue);
+		if (!cb(lib, data))
+			break;
+		EINA_LIST_FOREACH(lib->deps, l, dep)
+		{
+			if (eina_list_data_find(visited, dep))
+				continue;
+			visited = eina_list_append(visited, dep);
+			queue = eina_list_append(queue, dep);
+		}
+	}
+	eina_list_free(queue);
+	eina_list_free(visited);
+}
+
+static Eina_Bool _ender_lib_hash_cb(const Ender_Lib *lib, void *data)
+{
+	uint32_t *hash = data;
+	uint32_t hashes[2];
+
+	hashes[0] = *hash;
+	hashes[1] = lib->source_hash;
+	*hash = eina_hash_superfast((const char *)hashes, sizeof(hashes));
+	return EINA_TRUE;
+}
+
+typedef struct _Ender_Lib_Item_Find
+{
+	const char *name;
+	Ender_Item *item;
+} Ender_Lib_Item_Find;
+
+static Eina_Bool _ender_lib_item_find_cb(const Ender_Lib *lib, void *data)
+{
+	Ender_Lib_Item_Find *find = data;
+
+	find->item = eina_hash_find(lib->items, find->name);
+	return find->item ? EINA_FALSE : EINA_TRUE;
+}
+
+static Eina_Bool _ender_lib_resolved_add_cb(const Ender_Lib *lib, void *data)
+{
+	Eina_Hash *resolved = data;
+	Ender_Item *i;
+	Eina_Iterator *it;
+
+	it = eina_hash_iterator_data_new(lib->items);
+	EINA_ITERATOR_FOREACH(it, i)
+	{
+		const char *name;
+
+		/* the closest lib shadows the others */
+		name = ender_item_name_get(i);
+		if (!eina_hash_find(resolved, name))
+			eina_hash_direct_add(resolved, name, i);
+	}
+	eina_iterator_free(it);
+	return EINA_TRUE;
+}
+
+static Eina_Hash * _ender_lib_resolved_new(const Ender_Lib *thiz)
+{
+	Eina_Hash *resolved;
+
+	resolved = eina_hash_string_superfast_new(NULL);
+	_ender_lib_deps_foreach(thiz, _ender_lib_resolved_add_cb, resolved);
+	if (thiz != _c_lib)
+		_ender_lib_resolved_add_cb(_c_lib, resolved);
+	DBG("Lib '%s' resolves %d items", thiz->name,
+			eina_hash_population(resolved));
+	return resolved;
+}
+
+static Eina_Bool _ender_lib_depends_cb(const Ender_Lib *lib, void *data)
+{
+	const Ender_Lib **dep = data;
+
+	if (lib != *dep)
+		return EINA_TRUE;
+	*dep = NULL;
+	return EINA_FALSE;
+}
+
+/* Whether a lib depends on another, directly or not */
+static Eina_Bool _ender_lib_depends(const Ender_Lib *thiz, const Ender_Lib *dep)
+{
+	if (thiz == dep)
+		return EINA_FALSE;
+	_ender_lib_deps_foreach(thiz, _ender_lib_depends_cb, &dep);
+	return dep ? EINA_FALSE : EINA_TRUE;
+}
+
+/* Find the first library registered with a name */
+static Ender_Lib * _ender_lib_table_find(const Ender_Lib_Table *t,
+		const char *name)
+{
+	unsigned int lo = 0;
+	unsigned int hi;
+
+	if (!t || !name) return NULL;
+
+	hi = t->count;
+	while (lo < hi)
+	{
+		unsigned int mid = (lo + hi) / 2;
+
+		if (strcmp(t->libs[mid]->name, name) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo < t->count && !strcmp(t->libs[lo]->name, name))
+		return t->libs[lo];
+	return NULL;
+}
+
+/* Start a lookup, nothing retired from now on is freed until it ends */
+static unsigned int _ender_lib_read_begin(void)
+{
+	unsigned int epoch;
+
+	for (;;)
+	{
+		epoch = ENDER_ATOMIC_GET(&_epoch);
+		ENDER_ATOMIC_ADD(&_readers[epoch & 1], 1);
+		ENDER_ATOMIC_FENCE();
+		/* the epoch might have changed before being counted on it */
+		if (ENDER_ATOMIC_GET(&_epoch) == epoch)
+			return epoch;
+		ENDER_ATOMIC_ADD(&_readers[epoch & 1], -1);
+	}
+}
+
+static void _ender_lib_read_end(unsigned int epoch)
+{
+	ENDER_ATOMIC_ADD(&_readers[epoch & 1], -1);
+}
+
+/* Find a registered library, from any thread and without locks */
+static Ender_Lib * _ender_lib_registered_find(const char *name)
+{
+	Ender_Lib *lib;
+	unsigned int epoch;
+
+	epoch = _ender_lib_read_begin();
+	lib = _ender_lib_table_find(ENDER_ATOMIC_GET(&_libraries), name);
+	_ender_lib_read_end(epoch);
+	return lib;
+}
+
+/* Create a new table with the libraries of another table plus a new one */
+static Ender_Lib_Table * _ender_lib_table_add(const Ender_Lib_Table *old,
+		Ender_Lib *lib)
+{
+	Ender_Lib_Table *t;
+	unsigned int count;
+	unsigned int idx = 0;
+
+	count = old ? old->count : 0;
+	t = malloc(sizeof(Ender_Lib_Table) + (count + 1) * sizeof(Ender_Lib *));
+	t->count = count + 1;
+	/* keep the registration order of the libraries with the same name */
+	while (idx < count && strcmp(old->libs[idx]->name, lib->name) <= 0)
+	{
+		t->libs[idx] = old->libs[idx];
+		idx++;
+	}
+	t->libs[idx] = lib;
+	for (; idx < count; idx++)
+		t->libs[idx + 1] = old->libs[idx];
+	return t;
+}
+
+/* Create a new table with the libraries of another table but one */
+static Ender_Lib_Table * _ender_lib_table_remove(const Ender_Lib_Table *old,
+		Ender_Lib *lib)
+{
+	Ender_Lib_Table *t;
+	unsigned int i;
+	unsigned int idx = 0;
+
+	t = malloc(sizeof(Ender_Lib_Table) + (old->count - 1) * sizeof(Ender_Lib *));
+	t->count = old->count - 1;
+	for (i = 0; i < old->count; i++)
+	{
+		if (old->libs[i] != lib)
+			t->libs[idx++] = old->libs[i];
+	}
+	return t;
+}
+
+static void _ender_lib_retired_free(Eina_List **retired)
+{
+	Ender_Lib_Retired *r;
+
+	EINA_LIST_FREE(*retired, r)
+	{
+		r->free_cb(r->data);
+		free(r);
+	}
+}
+
+/* Free what was retired once nobody can be looking at it. The table lock
+ * must be taken
+ */
+static void _ender_lib_table_reclaim(void)
+{
+	unsigned int prev;
+
+	eina_lock_take(&_retire_lock);
+	_retired[_epoch & 1] = eina_list_merge(_retired[_epoch & 1], _retiring);
+	_retiring = NULL;
+	eina_lock_release(&_retire_lock);
+
+	/* the lookups of the previous epoch started before anything retired
+	 * during the current one was replaced, once they are finished what was
+	 * retired during the previous epoch can be freed and a new epoch starts
+	 */
+	ENDER_ATOMIC_FENCE();
+	prev = (_epoch - 1) & 1;
+	if (ENDER_ATOMIC_GET(&_readers[prev]))
+		return;
+	_ender_lib_retired_free(&_retired[prev]);
+	ENDER_ATOMIC_SET(&_epoch, _epoch + 1);
+}
+
+/* Free something once the lookups that might be using it have finished. The
+ * table lock must be taken
+ */
+static void _ender_lib_retire(void *data, Eina_Free_Cb free_cb)
+{
+	Ender_Lib_Retired *r;
+
+	r = malloc(sizeof(Ender_Lib_Retired));
+	r->data = data;
+	r->free_cb = free_cb;
+	_retired[_epoch & 1] = eina_list_append(_retired[_epoch & 1], r);
+}
+
+static void _ender_lib_unloaded_free(void *data)
+{
+	ender_lib_free(data);
+}
+
+static void _ender_lib_deps_free(void *data)
+{
+	eina_list_free(data);
+}
+
+/* Replace the table of libraries. The table lock must be taken */
+static void _ender_lib_table_publish(Ender_Lib_Table *t)
+{
+	Ender_Lib_Table *old;
+
+	old = _libraries;
+	ENDER_ATOMIC_SET(&_libraries, t);
+	if (old)
+		_ender_lib_retire(old, free);
+	_ender_lib_table_reclaim();
+}
+
+/* Collect every function that has a symbol, including the getters and setters
+ * of the attributes
+ */
+static void _ender_lib_item_functions_collect(Ender_Item *i,
+		Eina_List **functions)
+{
+	Ender_Item *other;
+	Eina_List *items = NULL;
+
+	switch (ender_item_type_get(i))
+	{
+		case ENDER_ITEM_TYPE_FUNCTION:
+		if (!(ender_item_function_flags_get(i) & ENDER_ITEM_FUNCTION_FLAG_CALLBACK))
+			*functions = eina_list_append(*functions, ender_item_ref(i));
+		return;
+
+		case ENDER_ITEM_TYPE_ATTR:
+		other = ender_item_attr_getter_get(i);
+		if (other)
+			*functions = eina_list_append(*functions, other);
+		other = ender_item_attr_setter_get(i);
+		if (other)
+			*functions = eina_list_append(*functions, other);
+		return;
+
+		case ENDER_ITEM_TYPE_OBJECT:
+		items = ender_item_object_functions_get(i);
+		items = eina_list_merge(items, ender_item_object_props_get(i));
+		break;
+
+		case ENDER_ITEM_TYPE_STRUCT:
+		items = ender_item_struct_functions_get(i);
+		items = eina_list_merge(items, ender_item_struct_fields_get(i));
+		break;
+
+		case ENDER_ITEM_TYPE_DEF:
+		items = ender_item_def_functions_get(i);
+		break;
+
+		default:
+		return;
+	}
+
+	EINA_LIST_FREE(items, other)
+	{
+		_ender_lib_item_functions_collect(other, functions);
+		ender_item_unref(other);
+	}
+}
+
+static int _ender_lib_profile_cmp(const void *d1, const void *d2)
+{
+	uint64_t t1 = 0;
+	uint64_t t2 = 0;
+
+	ender_item_function_profile_get((Ender_Item *)d1, NULL, NULL, &t1, NULL);
+	ender_item_function_profile_get((Ender_Item *)d2, NULL, NULL, &t2, NULL);
+	if (t1 == t2)
+		return 0;
+	return t1 < t2 ? 1 : -1;
+}
+
+static Eina_List * _ender_lib_functions_collect(const Ender_Lib *thiz)
+{
+	Ender_Item *i;
+	Eina_List *ret = NULL;
+	Eina_Iterator *it;
+	unsigned int epoch;
+
+	epoch = _ender_lib_read_begin();
+	it = eina_hash_iterator_data_new(ENDER_ATOMIC_GET(&thiz->items));
+	EINA_ITERATOR_FOREACH(it, i)
+	{
+		_ender_lib_item_functions_collect(i, &ret);
+	}
+	eina_iterator_free(it);
+	_ender_lib_read_end(epoch);
+
+	return ret;
+}
+
+/* The symbols are stored on the function items, the calls from any thread
+ * then find them already loaded. The lib can not be unloaded nor reloaded
+ * while it is being resolved
+ */
+static void * _ender_lib_resolver_cb(void *data EINA_UNUSED,
+		Eina_Thread t EINA_UNUSED)
+{
+	eina_lock_take(&_resolver_lock);
+	while (_resolver_running)
+	{
+		Ender_Lib *lib;
+		Ender_Item *f;
+		Eina_List *functions;
+		int count = 0;
+		int missing = 0;
+
+		if (!_resolver_pending)
+		{
+			eina_condition_wait(&_resolver_cond);
+			continue;
+		}
+		lib = eina_list_data_get(_resolver_pending);
+		_resolver_pending = eina_list_remove_list(_resolver_pending,
+				_resolver_pending);
+		_resolver_current = lib;
+		eina_lock_release(&_resolver_lock);
+
+		functions = _ender_lib_functions_collect(lib);
+		EINA_LIST_FREE(functions, f)
+		{
+			if (!ender_item_function_sym_load(f, EINA_FALSE))
+			{
+				WRN("Missing symbol '%s' on lib '%s'",
+						ender_item_function_symname_get(f),
+						lib->name);
+				missing++;
+			}
+			count++;
+			ender_item_unref(f);
+		}
+		INF("%d symbols of lib '%s' resolved in the background, %d missing",
+				count, lib->name, missing);
+
+		eina_lock_take(&_resolver_lock);
+		_resolver_current = NULL;
+		eina_condition_broadcast(&_resolver_cond);
+	}
+	eina_lock_release(&_resolver_lock);
+	return NULL;
+}
+
+static void _ender_lib_resolver_add(Ender_Lib *lib)
+{
+	eina_lock_take(&_resolver_lock);
+	if (_resolver_running)
+	{
+		_resolver_pending = eina_list_append(_resolver_pending, lib);
+		eina_condition_broadcast(&_resolver_cond);
+	}
+	eina_lock_release(&_resolver_lock);
+}
+
+/* Remove a lib from the pending ones and wait until it is not being resolved
+ */
+static void _ender_lib_resolver_cancel(Ender_Lib *lib)
+{
+	eina_lock_take(&_resolver_lock);
+	_resolver_pending = eina_list_remove(_resolver_pending, lib);
+	while (_resolver_current == lib)
+		eina_condition_wait(&_resolver_cond);
+	eina_lock_release(&_resolver_lock);
+}
+
+static void _ender_lib_resolver_start(void)
+{
+	_resolver_running = EINA_TRUE;
+	if (!eina_thread_create(&_resolver, EINA_THREAD_BACKGROUND, -1,
+			_ender_lib_resolver_cb, NULL))
+	{
+		ERR("Impossible to create the symbol resolver thread");
+		_resolver_running = EINA_FALSE;
+	}
+}
+
+static void _ender_lib_resolver_stop(void)
+{
+	Eina_Bool running;
+
+	eina_lock_take(&_resolver_lock);
+	running = _resolver_running;
+	_resolver_running = EINA_FALSE;
+	_resolver_pending = eina_list_free(_resolver_pending);
+	eina_condition_broadcast(&_resolver_cond);
+	eina_lock_release(&_resolver_lock);
+	if (running)
+		eina_thread_join(_resolver);
+}
+
+static void _ender_lib_description_free(void *data)
+{
+	Ender_Lib_Description *d = data;
+
+	eina_list_free(d->dependents);
+	free(d->name);
+	free(d->file);
+	free(d);
+}
+
+/* Register the lib of a description, from its cache when possible. In case
+ * it is parsed concurrently with others and extends the objects of another
+ * lib nothing is registered and it returns EINA_FALSE
+ */
+static Eina_Bool _ender_lib_description_parse(Ender_Lib_Description *d,
+		Eina_Bool concurrent)
+{
+	Ender_Lib *lib;
+	Eina_Bool deferred = EINA_FALSE;
+
+	if (d->image)
+	{
+		Ender_Lib *image_lib;
+
+		image_lib = ender_cache_image_load(d->image->data, d->image->size);
+		if (!image_lib)
+		{
+			ERR("Invalid image for lib '%s'", d->name);
+			return EINA_TRUE;
+		}
+		image_lib->image = d->image;
+		image_lib->source_hash = ender_cache_image_hash_get(d->image->data,
+				d->image->size);
+		ender_lib_register(image_lib);
+		return EINA_TRUE;
+	}
+
+	if (ender_cache_load(d->name, d->file))
+		return EINA_TRUE;
+
+	DBG("Parsing file '%s'", d->file);
+	ender_parser_file_parse(d->file, concurrent ? &deferred : NULL);
+	if (deferred)
+		return EINA_FALSE;
+	lib = _ender_lib_registered_find(d->name);
+	if (lib)
+	{
+		ender_cache_source_hash_get(d->file, &lib->source_hash);
+		ender_cache_save(lib, d->file);
+	}
+	return EINA_TRUE;
+}
+
+static Eina_Bool _ender_lib_description_deps_cb(const Eina_Hash *hash EINA_UNUSED,
+		const void *key EINA_UNUSED, void *data, void *fdata EINA_UNUSED)
+{
+	Ender_Lib_Description *d = data;
+	Eina_List *includes;
+	char *name;
+
+	if (d->image)
+		includes = ender_cache_image_deps_get(d->image->data,
+				d->image->size);
+	else
+		includes = ender_parser_file_includes_get(d->file);
+	EINA_LIST_FREE(includes, name)
+	{
+		Ender_Lib_Description *dep;
+
+		dep = eina_hash_find(_descriptions, name);
+		if (dep && dep != d)
+		{
+			dep->dependents = eina_list_append(dep->dependents, d);
+			d->pending++;
+		}
+		free(name);
+	}
+	/* the includes are registered before, no need to parse them */
+	ENDER_ATOMIC_SET(&d->parsed, EINA_TRUE);
+	return EINA_TRUE;
+}
+
+static Eina_Bool _ender_lib_description_ready_cb(const Eina_Hash *hash EINA_UNUSED,
+		const void *key EINA_UNUSED, void *data, void *fdata)
+{
+	Ender_Lib_Loader *loader = fdata;
+	Ender_Lib_Description *d = data;
+
+	if (!d->pending)
+		loader->ready = eina_list_append(loader->ready, d);
+	return EINA_TRUE;
+}
+
+/* the ones on an include cycle or including one are never ready, they are
+ * parsed sequentially as the lazy loading does
+ */
+static Eina_Bool _ender_lib_description_left_cb(const Eina_Hash *hash EINA_UNUSED,
+		const void *key EINA_UNUSED, void *data, void *fdata)
+{
+	Ender_Lib_Description *d = data;
+	Eina_List **left = fdata;
+
+	if (d->pending || d->deferred)
+	{
+		ENDER_ATOMIC_SET(&d->parsed, EINA_FALSE);
+		*left = eina_list_append(*left, key);
+	}
+	return EINA_TRUE;
+}
+
+static void * _ender_lib_loader_cb(void *data, Eina_Thread t EINA_UNUSED)
+{
+	Ender_Lib_Loader *loader = data;
+
+	eina_lock_take(&loader->lock);
+	for (;;)
+	{
+		Ender_Lib_Description *d;
+		Ender_Lib_Description *dd;
+		Eina_List *l;
+
+		while (!loader->ready && loader->running)
+			eina_condition_wait(&loader->cond);
+		/* nothing else will be ready */
+		if (!loader->ready)
+			break;
+
+		d = eina_list_data_get(loader->ready);
+		loader->ready = eina_list_remove_list(loader->ready, loader->ready);
+		loader->running++;
+		eina_lock_release(&loader->lock);
+
+		if (!_ender_lib_description_parse(d, EINA_TRUE))
+			d->deferred = EINA_TRUE;
+
+		eina_lock_take(&loader->lock);
+		loader->running--;
+		/* the ones that include a deferred one are never ready */
+		EINA_LIST_FOREACH(d->dependents, l, dd)
+		{
+			if (!d->deferred && !--dd->pending)
+				loader->ready = eina_list_append(loader->ready, dd);
+		}
+		eina_condition_broadcast(&loader->cond);
+	}
+	eina_lock_release(&loader->lock);
+	return NULL;
+}
+
+/* Parse every description, the independent ones in parallel. The registry
+ * must be locked
+ */
+static void _ender_lib_descriptions_load(void)
+{
+	Ender_Lib_Loader loader;
+	Eina_Thread *threads;
+	Eina_List *left = NULL;
+	const char *name;
+	int nthreads;
+	int i;
+
+	nthreads = eina_cpu_count();
+	if (nthreads > eina_hash_population(_descriptions))
+		nthreads = eina_hash_population(_descriptions);
+	if (nthreads < 1)
+		return;
+
+	eina_hash_foreach(_descriptions, _ender_lib_description_deps_cb, NULL);
+	loader.ready = NULL;
+	loader.running = 0;
+	eina_hash_foreach(_descriptions, _ender_lib_description_ready_cb, &loader);
+	eina_lock_new(&loader.lock);
+	eina_condition_new(&loader.cond, &loader.lock);
+
+	/* the current thread is one of the loaders */
+	threads = calloc(nthreads, sizeof(Eina_Thread));
+	for (i = 1; i < nthreads; i++)
+	{
+		if (!eina_thread_create(&threads[i], EINA_THREAD_NORMAL, -1,
+				_ender_lib_loader_cb, &loader))
+			break;
+	}
+	nthreads = i;
+	_ender_lib_loader_cb(&loader, eina_thread_self());
+	for (i = 1; i < nthreads; i++)
+		eina_thread_join(threads[i]);
+	free(threads);
+
+	eina_condition_free(&loader.cond);
+	eina_lock_free(&loader.lock);
+
+	eina_hash_foreach(_descriptions, _ender_lib_description_left_cb, &left);
+	EINA_LIST_FREE(left, name)
+		ender_lib_description_load(name);
+}
+
+static int _ender_lib_image_symbol_cmp(const void *key, const void *data)
+{
+	const Ender_Lib_Image_Symbol *sym = data;
+
+	return strcmp(key, sym->name);
+}
+
+static void _ender_lib_dir_list_cb(const char *name, const char *path, void *data)
+{
+	Ender_Lib_Description *d;
 	char *token;
 	char *fname;
 
 	token = strchr(name, '.');
 	if (!token) return;
 
-	fname = strdup(name);
-	fname[token - name] = '\0';
-	lib = ender_lib_find(fname);
-	if (lib)
+	fname = strndup(name, token - name);
+	if (eina_hash_find(_descriptions, fname))
 	{
-		INF("Library '%s' already parsed", fname);
+		INF("Library '%s' already described", fname);
 		free(fname);
 		return;
 	}
-	free(fname);
 
-	if (asprintf(&file, "%s/%s", path, name) < 0)
+	d = calloc(1, sizeof(Ender_Lib_Description));
+	if (asprintf(&d->file, "%s/%s", path, name) < 0)
+	{
+		free(d);
+		free(fname);
 		return;
-
-	DBG("Parsing file '%s'", file);
-	f = fopen(file, "r");
-	ender_parser_parse(f);
-	fclose(f);
-	free(file);
+	}
+	DBG("Library '%s' described on '%s'", fname, d->file);
+	d->name = fname;
+	eina_hash_add(_descriptions, fname, d);
 }
 
 /*============================================================================*
@@ -86,70 +922,53 @@ void ender_lib_init(void)
 {
 	if (!_init++)
 	{
-		Ender_Item *i;
+		const char *dir;
 
-		_libraries = eina_hash_string_superfast_new(
-				EINA_FREE_CB(ender_lib_free));
+		eina_lock_new(&_dl_lock);
+		eina_lock_new(&_table_lock);
+		eina_lock_new(&_registry_lock);
+		eina_lock_new(&_resolver_lock);
+		eina_lock_new(&_retire_lock);
+		eina_condition_new(&_resolver_cond, &_resolver_lock);
 		/* add the main c lib */
 		_c_lib = ender_lib_new();
 		ender_lib_name_set(_c_lib, "c");
-		/* bool */
-		i = ender_item_basic_new();
-		ender_item_name_set(i, "bool");
-		ender_item_basic_value_type_set(i, ENDER_VALUE_TYPE_BOOL);
-		ender_lib_item_add(_c_lib, i);
-		/* uint8 */
-		i = ender_item_basic_new();
-		ender_item_name_set(i, "uint8");
-		ender_item_basic_value_type_set(i, ENDER_VALUE_TYPE_UINT8);
-		ender_lib_item_add(_c_lib, i);
-		/* int8 */
-		i = ender_item_basic_new();
-		ender_item_name_set(i, "int8");
-		ender_item_basic_value_type_set(i, ENDER_VALUE_TYPE_INT8);
-		ender_lib_item_add(_c_lib, i);
-		/* uint32 */
-		i = ender_item_basic_new();
-		ender_item_name_set(i, "uint32");
-		ender_item_basic_value_type_set(i, ENDER_VALUE_TYPE_UINT32);
-		ender_lib_item_add(_c_lib, i);
-		/* int32 */
-		i = ender_item_basic_new();
-		ender_item_name_set(i, "int32");
-		ender_item_basic_value_type_set(i, ENDER_VALUE_TYPE_INT32);
-		ender_lib_item_add(_c_lib, i);
-		/* uint64 */
-		i = ender_item_basic_new();
-		ender_item_name_set(i, "uint64");
-		ender_item_basic_value_type_set(i, ENDER_VALUE_TYPE_UINT64);
-		ender_lib_item_add(_c_lib, i);
-		/* int64 */
-		i = ender_item_basic_new();
-		ender_item_name_set(i, "int64");
-		ender_item_basic_value_type_set(i, ENDER_VALUE_TYPE_INT64);
-		ender_lib_item_add(_c_lib, i);
-		/* double */
-		i = ender_item_basic_new();
-		ender_item_name_set(i, "double");
-		ender_item_basic_value_type_set(i, ENDER_VALUE_TYPE_DOUBLE);
-		ender_lib_item_add(_c_lib, i);
-		/* string */
-		i = ender_item_basic_new();
-		ender_item_name_set(i, "string");
-		ender_item_basic_value_type_set(i, ENDER_VALUE_TYPE_STRING);
-		ender_lib_item_add(_c_lib, i);
-		/* pointer */
-		i = ender_item_basic_new();
-		ender_item_name_set(i, "pointer");
-		ender_item_basic_value_type_set(i, ENDER_VALUE_TYPE_POINTER);
-		ender_lib_item_add(_c_lib, i);
-		/* pointer */
-		i = ender_item_basic_new();
-		ender_item_name_set(i, "size");
-		ender_item_basic_value_type_set(i, ENDER_VALUE_TYPE_SIZE);
-		ender_lib_item_add(_c_lib, i);
-		/* load all the libs on the data dir */
-		eina_file_dir_list(DESCRIPTIONS_DIR, EINA_FALSE, _ender_lib_dir_list_cb, NULL);
+		_ender_lib_basic_add(_c_lib, "bool", ENDER_VALUE_TYPE_BOOL);
+		_ender_lib_basic_add(_c_lib, "uint8", ENDER_VALUE_TYPE_UINT8);
+		_ender_lib_basic_add(_c_lib, "int8", ENDER_VALUE_TYPE_INT8);
+		_ender_lib_basic_add(_c_lib, "uint32", ENDER_VALUE_TYPE_UINT32);
+		_ender_lib_basic_add(_c_lib, "int32", ENDER_VALUE_TYPE_INT32);
+		_ender_lib_basic_add(_c_lib, "uint64", ENDER_VALUE_TYPE_UINT64);
+		_ender_lib_basic_add(_c_lib, "int64", ENDER_VALUE_TYPE_INT64);
+		_ender_lib_basic_add(_c_lib, "double", ENDER_VALUE_TYPE_DOUBLE);
+		_ender_lib_basic_add(_c_lib, "string", ENDER_VALUE_TYPE_STRING);
+		_ender_lib_basic_add(_c_lib, "pointer", ENDER_VALUE_TYPE_POINTER);
+		_ender_lib_basic_add(_c_lib, "size", ENDER_VALUE_TYPE_SIZE);
+		ender_lib_immortal_set(_c_lib);
+		ender_lib_resolved_build(_c_lib);
+		/* only find the libs on the data dir, they are parsed on demand */
+		_descriptions = eina_hash_string_superfast_new(
+				_ender_lib_description_free);
+		dir = getenv("ENDER_DESCRIPTIONS_DIR");
+		eina_file_dir_list(dir ? dir : DESCRIPTIONS_DIR, EINA_FALSE,
+				_ender_lib_dir_list_cb, NULL);
+		/* resolve the symbols of every registered lib on the background */
+		if (getenv("ENDER_SYMBOLS_RESOLVE") &&
+				!strcmp(getenv("ENDER_SYMBOLS_RESOLVE"), "1"))
+			_ender_lib_resolver_start();
+		if (getenv("ENDER_EAGER_LOAD") &&
+				!strcmp(getenv("ENDER_EAGER_LOAD"), "1"))
+		{
+			ender_lib_registry_lock();
+			_ender_lib_descriptions_load();
+			ender_lib_registry_unlock();
+		}
+		/* profile every call and dump the result on shutdown */
+		if (getenv("ENDER_PROFILE") && !strcmp(getenv("ENDER_PROFILE"), "1"))
+		{
+			ender_item_function_profile_enable(EINA_TRUE);
+			_profile_dump = EINA_TRUE;
+		}
 	}
 }
 
@@ -157,8 +976,40 @@ void ender_lib_shutdown(void)
 {
 	if (_init == 1)
 	{
-		eina_hash_free(_libraries);
+		Ender_Lib_Table *t;
+		unsigned int i;
+
+		_ender_lib_resolver_stop();
+		t = _libraries;
+		if (_profile_dump)
+		{
+			for (i = 0; t && i < t->count; i++)
+				ender_lib_profile_dump(t->libs[i]);
+		}
+		/* no lookup can be in progress anymore, the retired tables still
+		 * refer to the items
+		 */
+		_ender_lib_retired_free(&_retired[0]);
+		_ender_lib_retired_free(&_retired[1]);
+		/* the items of a lib might refer to items of other libs */
+		for (i = 0; t && i < t->count; i++)
+			_ender_lib_items_deinit(t->libs[i]);
+		_ender_lib_items_deinit(_c_lib);
+		for (i = 0; t && i < t->count; i++)
+			ender_lib_free(t->libs[i]);
+		free(t);
+		_libraries = NULL;
 		ender_lib_free(_c_lib);
+		/* the items released what they used */
+		_ender_lib_retired_free(&_retiring);
+		eina_hash_free(_descriptions);
+		_descriptions = NULL;
+		eina_condition_free(&_resolver_cond);
+		eina_lock_free(&_resolver_lock);
+		eina_lock_free(&_retire_lock);
+		eina_lock_free(&_registry_lock);
+		eina_lock_free(&_table_lock);
+		eina_lock_free(&_dl_lock);
 	}
 	_init--;
 }
@@ -179,9 +1030,9 @@ Ender_Lib * ender_lib_new(void)
 
 void ender_lib_free(Ender_Lib *thiz)
 {
-	eina_hash_free(thiz->items);
-	eina_list_free(thiz->deps);
-	free(thiz->name);
+	_ender_lib_deps_unpin(thiz);
+	_ender_lib_release(thiz);
+	eina_stringshare_del(thiz->name);
 	free(thiz->file);
 	free(thiz);
 }
@@ -207,7 +1058,7 @@ void ender_lib_name_set(Ender_Lib *thiz, const char *name)
 	{
 		return;
 	}
-	thiz->name = strdup(name);
+	thiz->name = eina_stringshare_add(name);
 	if (asprintf(&thiz->file, "lib%s.so", name) < 0)
 		return;
 }
@@ -227,23 +1078,84 @@ void ender_lib_dependency_add(Ender_Lib *thiz, const Ender_Lib *dep)
 	if (!thiz) return;
 	if (!dep) return;
 	thiz->deps = eina_list_append(thiz->deps, dep);
+	/* a stream parse releases the registry between its chunks */
+	ENDER_ATOMIC_ADD(&((Ender_Lib *)dep)->pins, 1);
+	thiz->pinning = EINA_TRUE;
+}
+
+/* The library must be complete, once registered it is visible from every
+ * thread and it can not be modified anymore
+ */
+/* Merge the items of the lib, its dependencies and the builtin types on a
+ * single table. Once the lib is complete, it is enough with one probe on it
+ * to find an item or to know that it does not exist
+ */
+void ender_lib_resolved_build(Ender_Lib *thiz)
+{
+	if (thiz->resolved)
+		eina_hash_free(thiz->resolved);
+	thiz->resolved = _ender_lib_resolved_new(thiz);
 }
 
 void ender_lib_register(Ender_Lib *thiz)
 {
-	Ender_Lib *other;
+	const Ender_Lib_Table *old;
+	Ender_Lib_Table *t;
 
 	if (!thiz) return;
 	if (!thiz->name) return;
 
-	other = eina_hash_find(_libraries, thiz->name);
-	if (other)
+	eina_lock_take(&_table_lock);
+	old = _libraries;
+	if (_ender_lib_table_find(old, thiz->name))
 	{
 		WRN("Library '%s' already registered", thiz->name);
 	}
 
 	DBG("Registering lib '%s'", thiz->name);
-	eina_hash_add(_libraries, thiz->name, thiz);
+	/* from now on the registered dependents are checked instead */
+	_ender_lib_deps_unpin(thiz);
+	ender_lib_immortal_set(thiz);
+	/* the parsed libs are resolved already, to link their items */
+	if (!thiz->resolved)
+		ender_lib_resolved_build(thiz);
+	t = _ender_lib_table_add(old, thiz);
+	_ender_lib_table_publish(t);
+	eina_lock_release(&_table_lock);
+	_ender_lib_resolver_add(thiz);
+}
+
+/* Serialize the parsing of the descriptions. The lookups do not need it */
+void ender_lib_registry_lock(void)
+{
+	eina_lock_take(&_registry_lock);
+}
+
+void ender_lib_registry_unlock(void)
+{
+	eina_lock_release(&_registry_lock);
+}
+
+/* Parse the description of a lib in case it is not registered yet. The
+ * registry must be locked
+ */
+const Ender_Lib * ender_lib_description_load(const char *name)
+{
+	Ender_Lib_Description *d;
+	const Ender_Lib *lib;
+
+	lib = _ender_lib_registered_find(name);
+	if (lib) return lib;
+
+	d = eina_hash_find(_descriptions, name);
+	/* a failed description is not parsed again. The parsing threads of the
+	 * eager loading only find the descriptions parsed
+	 */
+	if (!d || !ENDER_ATOMIC_CAS(&d->parsed, EINA_FALSE, EINA_TRUE))
+		return NULL;
+	_ender_lib_description_parse(d, EINA_FALSE);
+
+	return _ender_lib_registered_find(name);
 }
 
 void ender_lib_item_add(Ender_Lib *thiz, Ender_Item *i)
@@ -266,27 +1178,189 @@ void ender_lib_item_add(Ender_Lib *thiz, Ender_Item *i)
 
 	DBG("Adding item %p '%s' %d on '%s' lib", i, name, ender_item_type_get(i), thiz->name);
 	i->lib = thiz;
-	eina_hash_add(thiz->items, name, i);
+	/* the name is shared and lives as long as the item */
+	eina_hash_direct_add(thiz->items, name, i);
 }
 
-void ender_lib_load(Ender_Lib *thiz)
+/* Transfer the reference of an item to the lib, the lib will destroy it
+ * on its own destruction
+ */
+void ender_lib_item_own(Ender_Lib *thiz, Ender_Item *i)
 {
-	if (thiz->dl)
+	if (!i) return;
+	if (!thiz)
+	{
+		ender_item_unref(i);
 		return;
+	}
+	thiz->owned = eina_list_append(thiz->owned, i);
+}
 
-	DBG("Loading lib '%s'", thiz->file);
-	thiz->dl = dlopen(thiz->file, RTLD_LAZY);
+/* Set the hash of the description or image the lib comes from */
+void ender_lib_source_hash_set(Ender_Lib *thiz, uint32_t hash)
+{
+	thiz->source_hash = hash;
+}
+
+/* The hash of the sources of the lib and of every lib it depends on, the
+ * cache of a lib is outdated once any of them changes. The registry must be
+ * locked
+ */
+uint32_t ender_lib_hash_get(const Ender_Lib *thiz)
+{
+	uint32_t hash = 0;
+
+	_ender_lib_deps_foreach(thiz, _ender_lib_hash_cb, &hash);
+	return hash;
+}
+
+/* The items of the lib are added to an object of another lib, the lib can
+ * not be unloaded as the object keeps them
+ */
+void ender_lib_extends_set(Ender_Lib *thiz)
+{
+	thiz->extends = EINA_TRUE;
+}
+
+/* Make every item of the lib immortal, from now on ref and unref on them
+ * are no-ops. It must be called once the lib is complete
+ */
+void ender_lib_immortal_set(Ender_Lib *thiz)
+{
+	Ender_Item *i;
+	Eina_List *l;
+
+	EINA_LIST_FOREACH(thiz->owned, l, i)
+		ender_item_immortal_set(i);
+}
+
+void * ender_lib_load(Ender_Lib *thiz)
+{
+	void *dl;
+
+	eina_lock_take(&_dl_lock);
 	if (!thiz->dl)
 	{
-		CRI("Impossible to load the library '%s'", thiz->file);
+		DBG("Loading lib '%s'", thiz->file);
+		thiz->dl = dlopen(thiz->file, RTLD_LAZY);
+		if (!thiz->dl)
+		{
+			CRI("Impossible to load the library '%s'", thiz->file);
+		}
 	}
+	dl = thiz->dl;
+	eina_lock_release(&_dl_lock);
+	return dl;
 }
 
 void * ender_lib_sym_get(Ender_Lib *thiz, const char *name)
 {
-	ender_lib_load(thiz);
+	void *dl;
+
+	/* the symbols of a precompiled lib are linked with it */
+	if (thiz->image)
+	{
+		const Ender_Lib_Image_Symbol *sym;
+
+		sym = bsearch(name, thiz->image->symbols, thiz->image->nsymbols,
+				sizeof(Ender_Lib_Image_Symbol), _ender_lib_image_symbol_cmp);
+		if (sym)
+			return sym->sym;
+	}
+	/* the lib might be loaded from the background resolution. A lib that
+	 * can not be loaded has its symbols looked up on the global namespace
+	 */
+	dl = ender_lib_load(thiz);
 	DBG("Loading sym '%s' from lib '%s'", name, thiz->name);
-	return dlsym(thiz->dl, name);
+	return dlsym(dl, name);
+}
+
+/* Move the items and dependencies of a reloaded lib into a registered one.
+ * The previous items are still owned, the items of other libs might refer to
+ * them. The libs that depend on it get their resolved tables rebuilt. The
+ * other lib is freed
+ */
+void ender_lib_merge(Ender_Lib *thiz, Ender_Lib *other)
+{
+	Ender_Lib_Table *t;
+	Eina_Hash *items;
+	Eina_Hash *resolved;
+	Eina_List *deps;
+	Ender_Item *i;
+	Eina_Iterator *it;
+	unsigned int n;
+
+	/* the new tables are complete before being published, the lookups in
+	 * progress keep using the old ones
+	 */
+	if (!other->resolved)
+		ender_lib_resolved_build(other);
+	it = eina_hash_iterator_data_new(other->items);
+	EINA_ITERATOR_FOREACH(it, i)
+		i->lib = thiz;
+	eina_iterator_free(it);
+	ender_lib_immortal_set(other);
+	thiz->reloaded += eina_list_count(other->owned);
+	thiz->owned = eina_list_merge(thiz->owned, other->owned);
+	other->owned = NULL;
+	thiz->version = other->version;
+	thiz->kase = other->kase;
+	thiz->notation = other->notation;
+
+	_ender_lib_deps_unpin(other);
+	items = thiz->items;
+	deps = thiz->deps;
+	resolved = thiz->resolved;
+	ENDER_ATOMIC_SET(&thiz->items, other->items);
+	ENDER_ATOMIC_SET(&thiz->deps, other->deps);
+	ENDER_ATOMIC_SET(&thiz->resolved, other->resolved);
+	other->items = NULL;
+	other->deps = NULL;
+	other->resolved = NULL;
+	ender_lib_free(other);
+
+	eina_lock_take(&_table_lock);
+	_ender_lib_retire(items, EINA_FREE_CB(eina_hash_free));
+	_ender_lib_retire(deps, _ender_lib_deps_free);
+	_ender_lib_retire(resolved, EINA_FREE_CB(eina_hash_free));
+	/* the libs that depend on it resolve the new items too */
+	t = _libraries;
+	for (n = 0; n < t->count; n++)
+	{
+		Ender_Lib *lib = t->libs[n];
+
+		if (!_ender_lib_depends(lib, thiz))
+			continue;
+		resolved = lib->resolved;
+		ENDER_ATOMIC_SET(&lib->resolved, _ender_lib_resolved_new(lib));
+		_ender_lib_retire(resolved, EINA_FREE_CB(eina_hash_free));
+	}
+	_ender_lib_table_reclaim();
+	eina_lock_release(&_table_lock);
+}
+
+/* Free something once the lookups that might be using it have finished. It
+ * can be called with or without the table lock taken
+ */
+void ender_lib_retire(void *data, Eina_Free_Cb free_cb)
+{
+	Ender_Lib_Retired *r;
+
+	r = malloc(sizeof(Ender_Lib_Retired));
+	r->data = data;
+	r->free_cb = free_cb;
+	eina_lock_take(&_retire_lock);
+	_retiring = eina_list_append(_retiring, r);
+	eina_lock_release(&_retire_lock);
+}
+
+/* Count the prepared calls and closures, a lib can not be unloaded while
+ * they are in use
+ */
+void ender_lib_calls_add(const Ender_Lib *thiz, int count)
+{
+	if (!thiz) return;
+	ENDER_ATOMIC_ADD(&((Ender_Lib *)thiz)->calls, count);
 }
 /** @endcond */
 /*============================================================================*
@@ -294,12 +1368,201 @@ void * ender_lib_sym_get(Ender_Lib *thiz, const char *name)
  *============================================================================*/
 /**
  * Find a registered library by name
+ *
+ * The libraries described on the descriptions dir are parsed the first
+ * time they are requested.
+ * This function can be called from any thread, even while other libraries are
+ * being loaded.
  * @param name The name of the library to find
  * @return The library found, NULL otherwise
  */
 EAPI const Ender_Lib * ender_lib_find(const char *name)
 {
-	return eina_hash_find(_libraries, name);
+	const Ender_Lib *lib;
+
+	lib = _ender_lib_registered_find(name);
+	if (lib) return lib;
+
+	if (!_descriptions) return NULL;
+	/* the descriptions might be modified when adding an image */
+	ender_lib_registry_lock();
+	lib = ender_lib_description_load(name);
+	ender_lib_registry_unlock();
+	return lib;
+}
+
+/**
+ * Unload a library
+ *
+ * Releases the items of the library, their call interfaces, generated code
+ * and symbols, and closes the shared object of the library. The library can
+ * not be unloaded while other registered libraries depend on it, while there
+ * are prepared calls or closures of its functions not freed yet, while a
+ * library being parsed includes it or when it adds items to the objects of
+ * other libraries. A library found on the descriptions dir or added as an
+ * image is loaded again the next time it is requested.
+ *
+ * Any item of the library is invalid once unloaded, so the caller must
+ * ensure that no other thread is using the library. The lookups of other
+ * libraries can still be done from any thread.
+ * @param name The name of the library to unload
+ * @return EINA_TRUE if the library is unloaded, EINA_FALSE otherwise
+ */
+EAPI Eina_Bool ender_lib_unload(const char *name)
+{
+	Ender_Lib_Description *d;
+	Ender_Lib_Table *t;
+	Ender_Lib *lib;
+	unsigned int i;
+	Eina_Bool ret = EINA_FALSE;
+	int calls;
+
+	if (!name) return EINA_FALSE;
+
+	ender_lib_registry_lock();
+	eina_lock_take(&_table_lock);
+	t = _libraries;
+	lib = _ender_lib_table_find(t, name);
+	if (!lib)
+	{
+		WRN("Library '%s' not registered", name);
+		goto done;
+	}
+	for (i = 0; i < t->count; i++)
+	{
+		if (eina_list_data_find(t->libs[i]->deps, lib))
+		{
+			WRN("Library '%s' is used by '%s'", name, t->libs[i]->name);
+			goto done;
+		}
+	}
+	if (lib->extends)
+	{
+		WRN("Library '%s' extends the objects of other libraries", name);
+		goto done;
+	}
+	calls = ENDER_ATOMIC_GET(&lib->calls);
+	if (calls)
+	{
+		WRN("Library '%s' has %d prepared calls", name, calls);
+		goto done;
+	}
+	if (ENDER_ATOMIC_GET(&lib->pins))
+	{
+		WRN("Library '%s' is included by a library being parsed", name);
+		goto done;
+	}
+	_ender_lib_resolver_cancel(lib);
+
+	DBG("Unloading lib '%s'", name);
+	_ender_lib_release(lib);
+	eina_lock_take(&_dl_lock);
+	if (lib->dl)
+	{
+		dlclose(lib->dl);
+		lib->dl = NULL;
+	}
+	eina_lock_release(&_dl_lock);
+	/* the name is still compared by the lookups on the old table */
+	_ender_lib_retire(lib, _ender_lib_unloaded_free);
+	_ender_lib_table_publish(_ender_lib_table_remove(t, lib));
+
+	d = eina_hash_find(_descriptions, name);
+	if (d)
+		ENDER_ATOMIC_SET(&d->parsed, EINA_FALSE);
+	ret = EINA_TRUE;
+done:
+	eina_lock_release(&_table_lock);
+	ender_lib_registry_unlock();
+	return ret;
+}
+
+/**
+ * Reload a library
+ *
+ * Parses again the description of the library, or its image in case it was
+ * added with @ref ender_lib_image_add, and updates the library in place. The
+ * items that have not changed are kept, as well as their prepared calls,
+ * closures and symbols, only the changed and new items are created. The
+ * previous version of a changed or removed item is still valid until the
+ * library is unloaded, so other libraries that depend on it keep the
+ * items they were created with, while their lookups find the new ones.
+ *
+ * As the previous versions are kept, the memory of a library grows with
+ * every reload. Once the reloads of a library have created 65536 items it is
+ * not reloaded anymore, it has to be unloaded first. There is no watcher for
+ * the descriptions, a program that wants to reload a library when its
+ * description changes must call this function.
+ *
+ * The caller must ensure that no other thread is using the library during
+ * the reload. The lookups of other libraries can still be done from any
+ * thread.
+ * @param name The name of the library to reload
+ * @return EINA_TRUE if the library is reloaded, EINA_FALSE otherwise
+ */
+EAPI Eina_Bool ender_lib_reload(const char *name)
+{
+	Ender_Lib_Description *d;
+	Ender_Lib *lib;
+	Ender_Lib *other;
+	const void *image;
+	void *content = NULL;
+	size_t size;
+	Eina_Bool ret = EINA_FALSE;
+
+	if (!name) return EINA_FALSE;
+
+	ender_lib_registry_lock();
+	lib = _ender_lib_registered_find(name);
+	if (!lib)
+	{
+		WRN("Library '%s' not registered", name);
+		goto done;
+	}
+	d = _descriptions ? eina_hash_find(_descriptions, name) : NULL;
+	if (!d)
+	{
+		WRN("Library '%s' has no description", name);
+		goto done;
+	}
+	if (lib->reloaded >= ENDER_LIB_RELOADED_MAX)
+	{
+		WRN("Library '%s' keeps too many replaced items, unload it first",
+				name);
+		goto done;
+	}
+	if (d->image)
+	{
+		image = d->image->data;
+		size = d->image->size;
+	}
+	else
+	{
+		DBG("Parsing file '%s'", d->file);
+		other = ender_parser_file_lib_parse(d->file);
+		if (!other)
+			goto done;
+		content = ender_cache_image_new(other, d->file, &size);
+		if (content)
+			ender_cache_save(other, d->file);
+		ender_lib_free(other);
+		if (!content)
+			goto done;
+		image = content;
+	}
+	_ender_lib_resolver_cancel(lib);
+
+	ret = ender_cache_lib_reload(lib, image, size);
+	if (ret)
+	{
+		lib->image = d->image;
+		lib->source_hash = ender_cache_image_hash_get(image, size);
+		_ender_lib_resolver_add(lib);
+	}
+	free(content);
+done:
+	ender_lib_registry_unlock();
+	return ret;
 }
 
 /**
@@ -355,16 +1618,24 @@ EAPI Eina_List * ender_lib_dependencies_get(const Ender_Lib *thiz)
 	Ender_Lib *dep;
 	Eina_List *ret = NULL;
 	Eina_List *l;
+	unsigned int epoch;
 
-	EINA_LIST_FOREACH(thiz->deps, l, dep)
+	epoch = _ender_lib_read_begin();
+	EINA_LIST_FOREACH(ENDER_ATOMIC_GET(&thiz->deps), l, dep)
 	{
 		ret = eina_list_append(ret, dep);
 	}
+	_ender_lib_read_end(epoch);
 	return ret;
 }
 
 /**
  * Find an item
+ *
+ * The item is looked up on the library, then on its dependencies, direct or
+ * not, and finally on the builtin types. The items of the library shadow the
+ * ones of its dependencies, and the closest dependencies shadow the farthest
+ * ones.
  * @param thiz The library to find the item on
  * @param name The item name to find
  * @return The item found or NULL if it is not found. Use @ref ender_item_unref
@@ -372,30 +1643,31 @@ EAPI Eina_List * ender_lib_dependencies_get(const Ender_Lib *thiz)
  */
 EAPI Ender_Item * ender_lib_item_find(const Ender_Lib *thiz, const char *name)
 {
+	Ender_Lib_Item_Find find;
+	Eina_Hash *resolved;
 	Ender_Item *i;
-	Ender_Lib *dep;
-	Eina_List *l;
+	unsigned int epoch;
 
-	if (!thiz) return NULL;
+	if (!thiz || !name) return NULL;
 
-	i = eina_hash_find(thiz->items, name);
-	if (i) return ender_item_ref(i);
-
-	/* check on the dependencies */
-	EINA_LIST_FOREACH(thiz->deps, l, dep)
-	{
-		/* do not make it too recursive */
-		i = eina_hash_find(dep->items, name);
-		if (i) return i;
-	}
-
-	/* check on the c lib */
-	if (thiz != _c_lib)
+	/* the table might be replaced by a reload meanwhile */
+	epoch = _ender_lib_read_begin();
+	resolved = ENDER_ATOMIC_GET(&thiz->resolved);
+	if (resolved)
 	{
-		return ender_lib_item_find(_c_lib, name);
+		i = ender_item_ref(eina_hash_find(resolved, name));
+		_ender_lib_read_end(epoch);
+		return i;
 	}
+	_ender_lib_read_end(epoch);
 
-	return NULL;
+	/* the lib is still being parsed */
+	find.name = name;
+	find.item = NULL;
+	_ender_lib_deps_foreach(thiz, _ender_lib_item_find_cb, &find);
+	if (!find.item && thiz != _c_lib)
+		find.item = eina_hash_find(_c_lib->items, name);
+	return ender_item_ref(find.item);
 }
 
 /**
@@ -410,10 +1682,12 @@ EAPI Eina_List * ender_lib_item_list(const Ender_Lib *thiz, Ender_Item_Type type
 	Ender_Item *i;
 	Eina_List *ret = NULL;
 	Eina_Iterator *it;
+	unsigned int epoch;
 
 	if (!thiz) return ret;
 
-	it = eina_hash_iterator_data_new(thiz->items);
+	epoch = _ender_lib_read_begin();
+	it = eina_hash_iterator_data_new(ENDER_ATOMIC_GET(&thiz->items));
 	EINA_ITERATOR_FOREACH(it, i)
 	{
 		if (ender_item_type_get(i) == type)
@@ -421,6 +1695,196 @@ EAPI Eina_List * ender_lib_item_list(const Ender_Lib *thiz, Ender_Item_Type type
 	}
 
 	eina_iterator_free(it);
+	_ender_lib_read_end(epoch);
+	return ret;
+}
+
+/**
+ * Resolve the symbols of every function of a library
+ *
+ * By default the library is loaded and the symbols are resolved on the first
+ * call of every function. This function does it at once for the functions,
+ * getters, setters, constructors, ref and unref functions of the library, to
+ * avoid the latency of the first calls.
+ *
+ * @param thiz The library to resolve the symbols from
+ * @param flags A bitmask of @ref Ender_Lib_Symbols_Resolve_Flag
+ * @return The list of names of the symbols not found. Use free() to free
+ * every name on the list
+ */
+EAPI Eina_List * ender_lib_symbols_resolve(const Ender_Lib *thiz, int flags)
+{
+	Ender_Item *f;
+	Eina_List *functions;
+	Eina_List *ret = NULL;
+
+	if (!thiz) return ret;
+
+	functions = _ender_lib_functions_collect(thiz);
+	EINA_LIST_FREE(functions, f)
+	{
+		if (!ender_item_function_sym_load(f,
+				flags & ENDER_LIB_SYMBOLS_RESOLVE_FLAG_PREPARE))
+		{
+			const char *name;
+
+			name = ender_item_function_symname_get(f);
+			WRN("Missing symbol '%s' on lib '%s'", name, thiz->name);
+			ret = eina_list_append(ret, strdup(name));
+		}
+		ender_item_unref(f);
+	}
 	return ret;
 }
 
+/**
+ * Dump the profile of the functions of a library
+ *
+ * Prints the number of calls, errors, total and maximum time of every called
+ * function of the library, sorted by the total time. The profile is only
+ * available if it was enabled with @ref ender_profile_enable or with the
+ * ENDER_PROFILE environment variable.
+ *
+ * @param thiz The library to dump the profile from
+ */
+EAPI void ender_lib_profile_dump(const Ender_Lib *thiz)
+{
+	Ender_Item *f;
+	Eina_List *functions;
+	Eina_List *called = NULL;
+
+	if (!thiz) return;
+
+	functions = _ender_lib_functions_collect(thiz);
+	EINA_LIST_FREE(functions, f)
+	{
+		if (ender_item_function_profile_get(f, NULL, NULL, NULL, NULL))
+			called = eina_list_append(called, f);
+		else
+			ender_item_unref(f);
+	}
+	if (!called)
+		return;
+
+	called = eina_list_sort(called, -1, _ender_lib_profile_cmp);
+	printf("Profile of lib '%s':\n", thiz->name);
+	printf("%12s %8s %12s %12s %10s  %s\n", "calls", "errors", "total (ms)",
+			"max (us)", "avg (ns)", "function");
+	EINA_LIST_FREE(called, f)
+	{
+		unsigned long long calls;
+		unsigned long long errors;
+		uint64_t total;
+		uint64_t max;
+
+		ender_item_function_profile_get(f, &calls, &errors, &total, &max);
+		printf("%12llu %8llu %12.3f %12.3f %10.1f  %s\n", calls, errors,
+				total / 1e6, max / 1e3, (double)total / calls,
+				ender_item_function_symname_get(f));
+		ender_item_unref(f);
+	}
+}
+
+/**
+ * Get the symbols of a library
+ *
+ * The symbols are the ones of the functions, getters, setters,
+ * constructors, ref and unref functions of the library.
+ *
+ * @param thiz The library to get the symbols from
+ * @return The list of names of the symbols. Use free() to free every name on
+ * the list
+ */
+EAPI Eina_List * ender_lib_symbols_get(const Ender_Lib *thiz)
+{
+	Ender_Item *f;
+	Eina_List *functions;
+	Eina_List *ret = NULL;
+
+	if (!thiz) return ret;
+
+	functions = _ender_lib_functions_collect(thiz);
+	EINA_LIST_FREE(functions, f)
+	{
+		ret = eina_list_append(ret,
+				strdup(ender_item_function_symname_get(f)));
+		ender_item_unref(f);
+	}
+	return ret;
+}
+
+/**
+ * Create the image of a library
+ *
+ * The image is the flat representation of the library, the one used for the
+ * binary cache of the descriptions. It does not have any pointer, so it can
+ * be compiled into a program and added with @ref ender_lib_image_add. The
+ * items of other libraries are referred by name, so the libraries it depends
+ * on must be available when the image is loaded.
+ *
+ * @param thiz The library to create the image from
+ * @param[out] size The size of the image
+ * @return The image. Use free() to free it
+ */
+EAPI void * ender_lib_image_new(const Ender_Lib *thiz, size_t *size)
+{
+	void *ret;
+
+	if (!thiz || !size) return NULL;
+	/* the hashes of the deps */
+	ender_lib_registry_lock();
+	ret = ender_cache_image_new(thiz, NULL, size);
+	ender_lib_registry_unlock();
+	return ret;
+}
+
+/**
+ * Add a precompiled library
+ *
+ * The library is loaded from the image the first time it is requested,
+ * and its functions use the symbols of the image instead of loading the
+ * library. The image must be valid as long as ender is initialized. This
+ * function must be called after @ref ender_init and before other threads
+ * look up the library. The image replaces the description of a library with
+ * the same name, in case the library is already loaded the image is used the
+ * next time it is reloaded with @ref ender_lib_reload.
+ *
+ * @param image The image to add, usually generated by ender-compile
+ * @return EINA_TRUE if the image is added, EINA_FALSE otherwise
+ */
+EAPI Eina_Bool ender_lib_image_add(const Ender_Lib_Image *image)
+{
+	Ender_Lib_Description *d;
+	Ender_Lib_Description *old;
+	const char *name;
+
+	if (!image || !_descriptions) return EINA_FALSE;
+	if ((uintptr_t)image->data % sizeof(int64_t))
+	{
+		ERR("Unaligned image");
+		return EINA_FALSE;
+	}
+	name = ender_cache_image_name_get(image->data, image->size);
+	if (!name)
+	{
+		ERR("Invalid image");
+		return EINA_FALSE;
+	}
+
+	ender_lib_registry_lock();
+	d = calloc(1, sizeof(Ender_Lib_Description));
+	d->name = strdup(name);
+	d->image = image;
+	if (_ender_lib_registered_find(name))
+	{
+		DBG("Library '%s' already registered, using the image on reload",
+				name);
+		ENDER_ATOMIC_SET(&d->parsed, EINA_TRUE);
+	}
+	DBG("Library '%s' precompiled", name);
+	old = eina_hash_set(_descriptions, name, d);
+	if (old)
+		_ender_lib_description_free(old);
+	ender_lib_registry_unlock();
+	return EINA_TRUE;
+}
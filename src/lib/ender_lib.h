@@ -25,7 +25,41 @@
  * @{
  */
 
+/**
+ * Flags to use when resolving the symbols of a library
+ * @see ender_lib_symbols_resolve
+ */
+typedef enum _Ender_Lib_Symbols_Resolve_Flag
+{
+	/** Also build the call interface of every function */
+	ENDER_LIB_SYMBOLS_RESOLVE_FLAG_PREPARE = (1 << 0),
+} Ender_Lib_Symbols_Resolve_Flag;
+
+/**
+ * A symbol of a precompiled library
+ * @see Ender_Lib_Image
+ */
+typedef struct _Ender_Lib_Image_Symbol
+{
+	const char *name; /**< The name of the symbol */
+	void *sym; /**< The address of the symbol */
+} Ender_Lib_Image_Symbol;
+
+/**
+ * A precompiled library, as generated by ender-compile
+ * @see ender_lib_image_add
+ */
+typedef struct _Ender_Lib_Image
+{
+	const void *data; /**< The image, aligned to 64 bits */
+	size_t size; /**< The size of the image */
+	const Ender_Lib_Image_Symbol *symbols; /**< The symbols sorted by name */
+	unsigned int nsymbols; /**< The number of symbols */
+} Ender_Lib_Image;
+
 EAPI const Ender_Lib * ender_lib_find(const char *name);
+EAPI Eina_Bool ender_lib_unload(const char *name);
+EAPI Eina_Bool ender_lib_reload(const char *name);
 
 EAPI int ender_lib_version_get(const Ender_Lib *thiz);
 EAPI const char * ender_lib_name_get(const Ender_Lib *thiz);
@@ -34,6 +68,11 @@ EAPI Ender_Notation ender_lib_notation_get(const Ender_Lib *thiz);
 EAPI Eina_List * ender_lib_dependencies_get(const Ender_Lib *thiz);
 EAPI Ender_Item * ender_lib_item_find(const Ender_Lib *thiz, const char *name);
 EAPI Eina_List * ender_lib_item_list(const Ender_Lib *thiz, Ender_Item_Type type);
+EAPI Eina_List * ender_lib_symbols_resolve(const Ender_Lib *thiz, int flags);
+EAPI void ender_lib_profile_dump(const Ender_Lib *thiz);
+EAPI Eina_List * ender_lib_symbols_get(const Ender_Lib *thiz);
+EAPI void * ender_lib_image_new(const Ender_Lib *thiz, size_t *size);
+EAPI Eina_Bool ender_lib_image_add(const Ender_Lib_Image *image);
 
 /**
  * @}
@@ -22,6 +22,10 @@
 void ender_lib_init(void);
 void ender_lib_shutdown(void);
 void ender_lib_register(Ender_Lib *thiz);
+void ender_lib_resolved_build(Ender_Lib *thiz);
+void ender_lib_registry_lock(void);
+void ender_lib_registry_unlock(void);
+const Ender_Lib * ender_lib_description_load(const char *name);
 
 Ender_Lib * ender_lib_new(void);
 void ender_lib_free(Ender_Lib *thiz);
@@ -31,8 +35,16 @@ void ender_lib_case_set(Ender_Lib *thiz, Ender_Case kase);
 void ender_lib_notation_set(Ender_Lib *thiz, Ender_Notation notation);
 void ender_lib_dependency_add(Ender_Lib *thiz, const Ender_Lib *dep);
 void ender_lib_item_add(Ender_Lib *thiz, Ender_Item *i);
-void ender_lib_load(Ender_Lib *thiz);
+void ender_lib_item_own(Ender_Lib *thiz, Ender_Item *i);
+void ender_lib_extends_set(Ender_Lib *thiz);
+void ender_lib_source_hash_set(Ender_Lib *thiz, uint32_t hash);
+void ender_lib_retire(void *data, Eina_Free_Cb free_cb);
+uint32_t ender_lib_hash_get(const Ender_Lib *thiz);
+void ender_lib_immortal_set(Ender_Lib *thiz);
+void * ender_lib_load(Ender_Lib *thiz);
 void * ender_lib_sym_get(Ender_Lib *thiz, const char *name);
+void ender_lib_merge(Ender_Lib *thiz, Ender_Lib *other);
+void ender_lib_calls_add(const Ender_Lib *thiz, int count);
 
 #endif
 
@@ -20,9 +20,15 @@
 #include "ender_main.h"
 #include "ender_item.h"
 #include "ender_lib.h"
+#include "ender_value.h"
 
 #include "ender_main_private.h"
 #include "ender_lib_private.h"
+#include "ender_item_private.h"
+#include "ender_item_function_private.h"
+#include "ender_cache_private.h"
+#include "ender_call_thunk_private.h"
+#include "ender_call_jit_private.h"
 /*============================================================================*
  *                                  Local                                     *
  *============================================================================*/
@@ -36,13 +42,42 @@ int ender_log_dom = -1;
  *============================================================================*/
 /**
  * Initialize the ender library
+ *
+ * On x86-64 the function calls can be done through native code generated
+ * at runtime by setting the ENDER_JIT environment variable to 1. The
+ * generated code is registered on /tmp/perf-<pid>.map for profiling
+ *
+ * The libraries on the descriptions dir, or on ENDER_DESCRIPTIONS_DIR when
+ * set, are parsed the first time they are requested. Setting the ENDER_EAGER_LOAD environment variable to 1 parses
+ * all of them on the initialization instead, the ones that do not include
+ * each other in parallel
+ * @see ender_lib_find
+ *
+ * Once parsed, a description is stored on a binary cache which is loaded
+ * instead of the description until the description changes. The cache is
+ * stored on ENDER_CACHE_DIR, $XDG_CACHE_HOME/ender or $HOME/.cache/ender,
+ * setting the ENDER_CACHE environment variable to 0 disables it
+ *
+ * Setting the ENDER_SYMBOLS_RESOLVE environment variable to 1 loads the
+ * libraries and resolves their symbols on a background thread as they are
+ * registered, so the first calls do not need to do it
+ * @see ender_lib_symbols_resolve
+ *
+ * Setting the ENDER_PROFILE environment variable to 1 enables the profiling
+ * of the function calls and dumps the profile of every library on shutdown
+ * @see ender_profile_enable
  */
 EAPI void ender_init(void)
 {
 	if (!_init++)
 	{
 		eina_init();
+		/* the libs are parsed and resolved on several threads */
+		eina_threads_init();
 		ender_log_dom = eina_log_domain_register("ender", NULL);
+		ender_call_jit_init();
+		ender_item_init();
+		ender_cache_init();
 		ender_lib_init();
 	}
 }
@@ -55,7 +90,11 @@ EAPI void ender_shutdown(void)
 	if (_init == 1)
 	{
 		ender_lib_shutdown();
+		ender_cache_shutdown();
+		ender_item_shutdown();
+		ender_call_jit_shutdown();
 		eina_log_domain_unregister(ender_log_dom);
+		eina_threads_shutdown();
 		eina_shutdown();
 	}
 	_init--;
@@ -74,3 +113,15 @@ EAPI void ender_version(unsigned int *major, unsigned int *minor, unsigned int *
 	if (micro) *micro = VERSION_MICRO;
 }
 
+/**
+ * Enable or disable the profiling of the function calls
+ *
+ * When enabled, every call done through @ref ender_item_function_call keeps
+ * the number of calls, errors and the time spent on the function.
+ * @param enable EINA_TRUE to enable the profiling, EINA_FALSE to disable it
+ * @see ender_lib_profile_dump
+ */
+EAPI void ender_profile_enable(Eina_Bool enable)
+{
+	ender_item_function_profile_enable(enable);
+}
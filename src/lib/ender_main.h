@@ -43,6 +43,7 @@ typedef enum _Ender_Notation {
 EAPI void ender_init(void);
 EAPI void ender_shutdown(void);
 EAPI void ender_version(unsigned int *major, unsigned int *minor, unsigned int *micro);
+EAPI void ender_profile_enable(Eina_Bool enable);
 
 /**
  * @}
@@ -33,6 +33,7 @@
 
 #include "ender_main_private.h"
 #include "ender_lib_private.h"
+#include "ender_parser_private.h"
 #include "ender_item_attr_private.h"
 #include "ender_item_struct_private.h"
 #include "ender_item_function_private.h"
@@ -43,6 +44,10 @@
 #include "ender_item_constant_private.h"
 
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <ctype.h>
 /*============================================================================*
  *                                  Local                                     *
  *============================================================================*/
@@ -50,8 +55,27 @@
 typedef struct _Ender_Parser_Context Ender_Parser_Context;
 
 typedef Eina_Bool (*Ender_Parser_Tag_Ctor_Cb)(Ender_Parser_Context *c);
-typedef Eina_Bool (*Ender_Parser_Tag_Attrs_Set_Cb)(Ender_Parser_Context *c, const char *key,
-		const char *value);
+/* The attributes are looked up once and then dispatched by number */
+typedef enum _Ender_Parser_Attr
+{
+	ENDER_PARSER_ATTR_UNKNOWN,
+	ENDER_PARSER_ATTR_NAME,
+	ENDER_PARSER_ATTR_TYPE,
+	ENDER_PARSER_ATTR_CASE,
+	ENDER_PARSER_ATTR_VALUE,
+	ENDER_PARSER_ATTR_SYMNAME,
+	ENDER_PARSER_ATTR_VERSION,
+	ENDER_PARSER_ATTR_INHERITS,
+	ENDER_PARSER_ATTR_TRANSFER,
+	ENDER_PARSER_ATTR_BY_VALUE,
+	ENDER_PARSER_ATTR_VALUE_OF,
+	ENDER_PARSER_ATTR_DOWNCAST,
+	ENDER_PARSER_ATTR_NOTATION,
+	ENDER_PARSER_ATTR_DIRECTION,
+} Ender_Parser_Attr;
+
+typedef Eina_Bool (*Ender_Parser_Tag_Attrs_Set_Cb)(Ender_Parser_Context *c,
+		Ender_Parser_Attr attr, const char *value);
 typedef void (*Ender_Parser_Tag_Dtor_Cb)(Ender_Parser_Context *c);
 
 typedef struct _Ender_Parser_Tag
@@ -62,26 +86,96 @@ typedef struct _Ender_Parser_Tag
 	Ender_Parser_Tag_Attrs_Set_Cb attrs_set_cb;
 } Ender_Parser_Tag;
 
+/* The transient data of a parsing is allocated on an arena. The contexts are
+ * nested, so everything allocated since a context was created is released at
+ * once when the context is freed, by moving the arena back to that point
+ */
+typedef struct _Ender_Parser_Arena_Block Ender_Parser_Arena_Block;
+struct _Ender_Parser_Arena_Block
+{
+	Ender_Parser_Arena_Block *next;
+	size_t size;
+	size_t used;
+	char data[];
+};
+
+typedef struct _Ender_Parser_Arena
+{
+	/* the block in use, the ones before it are full */
+	Ender_Parser_Arena_Block *block;
+	/* the released blocks, to be used again */
+	Ender_Parser_Arena_Block *free;
+	int allocs;
+} Ender_Parser_Arena;
+
+typedef struct _Ender_Parser_Arena_Mark
+{
+	Ender_Parser_Arena_Block *block;
+	size_t used;
+} Ender_Parser_Arena_Mark;
+
+/* The references to other items are resolved once the lib is complete, this
+ * way the descriptions can refer to items described later. The links are
+ * resolved in steps, first the types, then the struct layouts, that need the
+ * defs resolved, and finally the getters, that need their args resolved
+ */
+typedef enum _Ender_Parser_Link_Type
+{
+	ENDER_PARSER_LINK_DEF,
+	ENDER_PARSER_LINK_INHERIT,
+	ENDER_PARSER_LINK_ARG,
+	ENDER_PARSER_LINK_PROP,
+	ENDER_PARSER_LINK_FIELD,
+	ENDER_PARSER_LINK_GETTER,
+} Ender_Parser_Link_Type;
+
+#define ENDER_PARSER_LINK_STEPS 3
+
+typedef struct _Ender_Parser_Link Ender_Parser_Link;
+struct _Ender_Parser_Link
+{
+	Ender_Parser_Link *next;
+	Ender_Parser_Link_Type type;
+	/* the item to link */
+	Ender_Item *i;
+	/* the item to add it to, if any */
+	Ender_Item *owner;
+	/* the name of the item it refers to */
+	const char *name;
+};
+
 typedef struct _Ender_Parser
 {
+	Ender_Parser_Arena arena;
+	/* the links live until the lib is complete */
+	Ender_Parser_Arena link_arena;
+	Ender_Parser_Link *links;
+	Ender_Parser_Link **links_last;
 	Eina_Array *context;
 	Ender_Lib *lib;
 	Ender_Case lcase;
 	Ender_Notation lnotation;
 	Eina_Bool failed;
+	/* keep the lib instead of registering it */
+	Eina_Bool keep;
+	/* other descriptions are parsed at the same time, the parsing stops
+	 * before modifying the items of other libs and is deferred
+	 */
+	Eina_Bool concurrent;
+	Eina_Bool deferred;
 } Ender_Parser;
 
 struct _Ender_Parser_Context {
+	/* the arena before the context was allocated */
+	Ender_Parser_Arena_Mark mark;
 	Ender_Parser *parser;
 	Ender_Parser_Tag *tag;
 	Ender_Item *i;
+	/* the item was created by a previous tag or by another lib */
+	Eina_Bool reopened;
 	void *prv;
 };
 
-typedef struct _Ender_Parser_Field {
-	char *type;
-} Ender_Parser_Field;
-
 typedef struct _Ender_Parser_Function {
 	char *symname;
 } Ender_Parser_Function;
@@ -90,6 +184,93 @@ typedef struct _Ender_Parser_Value {
 	char *value;
 } Ender_Parser_Value;
 
+/*----------------------------------------------------------------------------*
+ *                                  arena                                     *
+ *----------------------------------------------------------------------------*/
+#define ENDER_PARSER_ARENA_BLOCK 4096
+
+/* The memory is zeroed, as with calloc() */
+static void * _ender_parser_arena_alloc(Ender_Parser_Arena *thiz, size_t size)
+{
+	Ender_Parser_Arena_Block *b = thiz->block;
+	void *ret;
+
+	size = (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+	if (!b || b->used + size > b->size)
+	{
+		/* the next block is the first released one, in case it fits */
+		b = thiz->free;
+		if (b && b->size >= size)
+		{
+			thiz->free = b->next;
+		}
+		else
+		{
+			size_t bsize = ENDER_PARSER_ARENA_BLOCK;
+
+			if (size > bsize)
+				bsize = size;
+			b = malloc(sizeof(Ender_Parser_Arena_Block) + bsize);
+			b->size = bsize;
+			thiz->allocs++;
+		}
+		b->used = 0;
+		b->next = thiz->block;
+		thiz->block = b;
+	}
+	ret = b->data + b->used;
+	b->used += size;
+	memset(ret, 0, size);
+	return ret;
+}
+
+static char * _ender_parser_arena_strdup(Ender_Parser_Arena *thiz,
+		const char *str)
+{
+	size_t len = strlen(str) + 1;
+	char *ret;
+
+	ret = _ender_parser_arena_alloc(thiz, len);
+	memcpy(ret, str, len);
+	return ret;
+}
+
+static Ender_Parser_Arena_Mark _ender_parser_arena_mark(Ender_Parser_Arena *thiz)
+{
+	Ender_Parser_Arena_Mark mark;
+
+	mark.block = thiz->block;
+	mark.used = thiz->block ? thiz->block->used : 0;
+	return mark;
+}
+
+/* Release everything allocated after the mark */
+static void _ender_parser_arena_release(Ender_Parser_Arena *thiz,
+		Ender_Parser_Arena_Mark mark)
+{
+	while (thiz->block != mark.block)
+	{
+		Ender_Parser_Arena_Block *b = thiz->block;
+
+		thiz->block = b->next;
+		b->next = thiz->free;
+		thiz->free = b;
+	}
+	if (thiz->block)
+		thiz->block->used = mark.used;
+}
+
+static void _ender_parser_arena_cleanup(Ender_Parser_Arena *thiz)
+{
+	Ender_Parser_Arena_Block *b;
+
+	_ender_parser_arena_release(thiz, (Ender_Parser_Arena_Mark){ NULL, 0 });
+	while ((b = thiz->free))
+	{
+		thiz->free = b->next;
+		free(b);
+	}
+}
 /*----------------------------------------------------------------------------*
  *                                 helpers                                    *
  *----------------------------------------------------------------------------*/
@@ -110,39 +291,51 @@ static Ender_Parser_Context * _ender_parser_parent_context_get(Ender_Parser *thi
 	return c;
 }
 
-static char * _ender_parser_symname_generate(Ender_Parser *thiz, Ender_Item *i)
+/* In case some item has no name there is no symbol name */
+static char * _ender_parser_symname_generate(Ender_Parser *thiz,
+		Ender_Item *parent, const char *name)
 {
-	Ender_Item *parent;
 	char *ret;
 
-	parent = ender_item_parent_get(i);
+	if (!name)
+		return NULL;
 	if (parent)
 	{
+		Ender_Item *grandparent;
 		char *parent_name;
-		int count;
+		size_t len;
 
-		parent_name = _ender_parser_symname_generate(thiz, parent);
-		ender_item_unref(parent);
-		count = asprintf(&ret, "%s.%s", parent_name, ender_item_name_get(i));
-		free(parent_name);
-		if (count < 0)
+		grandparent = ender_item_parent_get(parent);
+		parent_name = _ender_parser_symname_generate(thiz, grandparent,
+				ender_item_name_get(parent));
+		ender_item_unref(grandparent);
+		if (!parent_name)
 			return NULL;
+		len = strlen(parent_name);
+		ret = _ender_parser_arena_alloc(&thiz->arena, len + strlen(name) + 2);
+		memcpy(ret, parent_name, len);
+		ret[len] = '.';
+		strcpy(ret + len + 1, name);
 	}
 	else
 	{
-		if (asprintf(&ret, "%s", ender_item_name_get(i)) < 0)
-			return NULL;
+		ret = _ender_parser_arena_strdup(&thiz->arena, name);
 	}
 	return ret;
 }
 
-/* TODO handle the library case type */
-static char * _ender_parser_symname_get(Ender_Parser *thiz, Ender_Item *i)
+/* The parent is given, the item might be added to it once the lib is
+ * complete. TODO handle the library case type
+ */
+static char * _ender_parser_symname_get(Ender_Parser *thiz, Ender_Item *parent,
+		const char *name)
 {
 	char *ret;
 	char *c;
 
-	ret = _ender_parser_symname_generate(thiz, i);
+	ret = _ender_parser_symname_generate(thiz, parent, name);
+	if (!ret)
+		return NULL;
 	for (c = ret; *c != '\0'; c++)
 	{
 		if (*c == '.')
@@ -150,13 +343,142 @@ static char * _ender_parser_symname_get(Ender_Parser *thiz, Ender_Item *i)
 	}
 	return ret;
 }
+/*----------------------------------------------------------------------------*
+ *                                  links                                     *
+ *----------------------------------------------------------------------------*/
+static Ender_Parser_Link * _ender_parser_link_add(Ender_Parser *thiz,
+		Ender_Parser_Link_Type type, Ender_Item *i, Ender_Item *owner)
+{
+	Ender_Parser_Link *l;
+
+	l = _ender_parser_arena_alloc(&thiz->link_arena, sizeof(Ender_Parser_Link));
+	l->type = type;
+	l->i = ender_item_ref(i);
+	l->owner = ender_item_ref(owner);
+	/* keep the order, the args and fields are added in it */
+	*thiz->links_last = l;
+	thiz->links_last = &l->next;
+	return l;
+}
+
+static void _ender_parser_link_name_set(Ender_Parser *thiz,
+		Ender_Parser_Link *l, const char *name)
+{
+	l->name = _ender_parser_arena_strdup(&thiz->link_arena, name);
+}
+
+static int _ender_parser_link_step(Ender_Parser_Link_Type type)
+{
+	switch (type)
+	{
+		case ENDER_PARSER_LINK_FIELD:
+		return 1;
+
+		case ENDER_PARSER_LINK_GETTER:
+		return 2;
+
+		default:
+		return 0;
+	}
+}
+
+static void _ender_parser_link_resolve(Ender_Parser *thiz, Ender_Parser_Link *l)
+{
+	Ender_Item *type = NULL;
+
+	if (l->name)
+	{
+		/* a single probe, the lib is already resolved */
+		type = ender_lib_item_find(thiz->lib, l->name);
+		if (!type)
+		{
+			if (l->type == ENDER_PARSER_LINK_INHERIT)
+				WRN("Inherit '%s' not found", l->name);
+			else
+				ERR("Can not find type '%s'", l->name);
+		}
+	}
+
+	switch (l->type)
+	{
+		case ENDER_PARSER_LINK_DEF:
+		if (type)
+			ender_item_def_type_set(l->i, type);
+		break;
+
+		case ENDER_PARSER_LINK_INHERIT:
+		if (type)
+			ender_item_object_inherit_set(l->i, type);
+		break;
+
+		case ENDER_PARSER_LINK_ARG:
+		if (type)
+			ender_item_arg_type_set(l->i, type);
+		/* the return has no owner, it is set on the function already */
+		if (l->owner)
+			ender_item_function_arg_add(l->owner, ender_item_ref(l->i));
+		break;
+
+		case ENDER_PARSER_LINK_PROP:
+		if (type)
+			ender_item_attr_type_set(l->i, type);
+		break;
+
+		case ENDER_PARSER_LINK_FIELD:
+		if (!type)
+		{
+			if (!l->name)
+				ERR("Field '%s' without type", ender_item_name_get(l->i));
+			break;
+		}
+		ender_item_attr_type_set(l->i, type);
+		ender_item_struct_field_add(l->owner, ender_item_ref(l->i));
+		break;
+
+		case ENDER_PARSER_LINK_GETTER:
+		ender_item_attr_getter_set(l->owner, ender_item_ref(l->i));
+		break;
+	}
+}
+
+static void _ender_parser_links_free(Ender_Parser *thiz)
+{
+	Ender_Parser_Link *l;
+
+	for (l = thiz->links; l; l = l->next)
+	{
+		ender_item_unref(l->i);
+		ender_item_unref(l->owner);
+	}
+	thiz->links = NULL;
+	thiz->links_last = &thiz->links;
+	_ender_parser_arena_cleanup(&thiz->link_arena);
+}
+
+/* Every item the lib can refer to is known now */
+static void _ender_parser_link(Ender_Parser *thiz)
+{
+	Ender_Parser_Link *l;
+	int step;
+
+	ender_lib_resolved_build(thiz->lib);
+	for (step = 0; step < ENDER_PARSER_LINK_STEPS; step++)
+	{
+		for (l = thiz->links; l; l = l->next)
+		{
+			if (_ender_parser_link_step(l->type) == step)
+				_ender_parser_link_resolve(thiz, l);
+		}
+	}
+	_ender_parser_links_free(thiz);
+}
 /*----------------------------------------------------------------------------*
  *                               common item                                  *
  *----------------------------------------------------------------------------*/
 static Eina_Bool _ender_parser_item_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
-	if (!strcmp(key, "name"))
+	if (attr == ENDER_PARSER_ATTR_NAME)
 	{
 		ender_item_name_set(c->i, value);
 	}
@@ -174,7 +496,8 @@ static void _ender_parser_common_function_ctor(Ender_Parser_Context *c)
 {
 	Ender_Parser_Function *thiz;
 
-	thiz = calloc(1, sizeof(Ender_Parser_Function));
+	thiz = _ender_parser_arena_alloc(&c->parser->arena,
+			sizeof(Ender_Parser_Function));
 	c->i = ender_item_function_new();
 	c->prv = thiz;
 }
@@ -186,27 +509,33 @@ static void _ender_parser_common_function_dtor(Ender_Parser_Context *c)
 	thiz = c->prv;
 	/* set the symbol name */
 	if (!thiz->symname)
-		thiz->symname = _ender_parser_symname_get(c->parser, c->i);
-	ender_item_function_symname_set(c->i, thiz->symname);
+	{
+		Ender_Parser_Context *parent;
 
-	/* free our private context */
+		parent = _ender_parser_parent_context_get(c->parser);
+		thiz->symname = _ender_parser_symname_get(c->parser, parent->i,
+				ender_item_name_get(c->i));
+	}
 	if (thiz->symname)
-		free(thiz->symname);
-	free(thiz);
+		ender_item_function_symname_set(c->i, thiz->symname);
+	else
+		WRN("Function without name nor symname");
+	/* our private context is released with the context */
 	c->prv = NULL;
 }
 
 static Eina_Bool _ender_parser_common_function_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
 	Ender_Parser_Function *thiz;
 
 	thiz = c->prv;
-	if (_ender_parser_item_attrs_set(c, key, value))
+	if (_ender_parser_item_attrs_set(c, attr, value))
 		return EINA_TRUE;
-	else if (!strcmp(key, "symname"))
+	else if (attr == ENDER_PARSER_ATTR_SYMNAME)
 	{
-		thiz->symname = strdup(value);
+		thiz->symname = _ender_parser_arena_strdup(&c->parser->arena,
+				value);
 	}
 	else
 	{
@@ -223,31 +552,25 @@ static Eina_Bool _ender_parser_common_function_attrs_set(Ender_Parser_Context *c
 static Eina_Bool _ender_parser_def_ctor(Ender_Parser_Context *c)
 {
 	c->i = ender_item_def_new();
+	c->prv = _ender_parser_link_add(c->parser, ENDER_PARSER_LINK_DEF, c->i,
+			NULL);
 	return EINA_TRUE;
 }
 
 static Eina_Bool _ender_parser_def_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
 	/* We add the item here instead of the dtor because some child functions
 	 * might want to reference the struct type
 	 */
-	if (!strcmp(key, "name"))
+	if (attr == ENDER_PARSER_ATTR_NAME)
 	{
 		ender_item_name_set(c->i, value);
 		ender_lib_item_add(c->parser->lib, ender_item_ref(c->i));
 	}
-	else if (!strcmp(key, "type"))
+	else if (attr == ENDER_PARSER_ATTR_TYPE)
 	{
-		Ender_Item *type;
-
-		type = ender_lib_item_find(c->parser->lib, value);
-		if (!type)
-		{
-			ERR("Can not find type '%s'", value);
-			return EINA_FALSE;
-		}
-		ender_item_def_type_set(c->i, type);
+		_ender_parser_link_name_set(c->parser, c->prv, value);
 	}
 	else
 	{
@@ -265,12 +588,12 @@ static Eina_Bool _ender_parser_struct_ctor(Ender_Parser_Context *c)
 }
 
 static Eina_Bool _ender_parser_struct_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
 	/* We add the item here instead of the dtor because some child functions
 	 * might want to reference the struct type
 	 */
-	if (!strcmp(key, "name"))
+	if (attr == ENDER_PARSER_ATTR_NAME)
 	{
 		ender_item_name_set(c->i, value);
 		ender_lib_item_add(c->parser->lib, ender_item_ref(c->i));
@@ -349,12 +672,39 @@ static void _ender_parser_function_dtor(Ender_Parser_Context *c)
 }
 
 static Eina_Bool _ender_parser_function_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
-	if (_ender_parser_common_function_attrs_set(c, key, value))
+	if (_ender_parser_common_function_attrs_set(c, attr, value))
 		return EINA_TRUE;
 	return EINA_FALSE;
 }
+/*----------------------------------------------------------------------------*
+ *                               callback tag                                 *
+ *----------------------------------------------------------------------------*/
+static Eina_Bool _ender_parser_callback_ctor(Ender_Parser_Context *c)
+{
+	c->i = ender_item_function_new();
+	ender_item_function_flags_set(c->i, ENDER_ITEM_FUNCTION_FLAG_CALLBACK);
+	return EINA_TRUE;
+}
+
+static Eina_Bool _ender_parser_callback_attrs_set(Ender_Parser_Context *c,
+		Ender_Parser_Attr attr, const char *value)
+{
+	/* We add the item here instead of the dtor because a callback can
+	 * receive itself as an argument
+	 */
+	if (attr == ENDER_PARSER_ATTR_NAME)
+	{
+		ender_item_name_set(c->i, value);
+		ender_lib_item_add(c->parser->lib, ender_item_ref(c->i));
+	}
+	else
+	{
+		return EINA_FALSE;
+	}
+	return EINA_TRUE;
+}
 /*----------------------------------------------------------------------------*
  *                                object tag                                  *
  *----------------------------------------------------------------------------*/
@@ -403,9 +753,9 @@ static void _ender_parser_object_dtor(Ender_Parser_Context *c)
 }
 
 static Eina_Bool _ender_parser_object_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
-	if (!strcmp(key, "name"))
+	if (attr == ENDER_PARSER_ATTR_NAME)
 	{
 		Ender_Item *exists;
 
@@ -414,6 +764,13 @@ static Eina_Bool _ender_parser_object_attrs_set(Ender_Parser_Context *c,
 		{
 			ender_item_unref(c->i);
 			c->i = exists;
+			c->reopened = EINA_TRUE;
+			if (ender_item_lib_get(exists) != c->parser->lib)
+			{
+				if (c->parser->concurrent)
+					c->parser->deferred = EINA_TRUE;
+				ender_lib_extends_set(c->parser->lib);
+			}
 		}
 		else
 		{
@@ -421,19 +778,13 @@ static Eina_Bool _ender_parser_object_attrs_set(Ender_Parser_Context *c,
 			ender_lib_item_add(c->parser->lib, ender_item_ref(c->i));
 		}
 	}
-	else if (!strcmp(key, "inherits"))
+	else if (attr == ENDER_PARSER_ATTR_INHERITS)
 	{
-		Ender_Item *inherits;
+		Ender_Parser_Link *l;
 
-		inherits = ender_lib_item_find(c->parser->lib, value);
-		if (!inherits)
-		{
-			WRN("Inherit '%s' not found", value);
-		}
-		else
-		{
-			ender_item_object_inherit_set(c->i, inherits);
-		}
+		l = _ender_parser_link_add(c->parser, ENDER_PARSER_LINK_INHERIT,
+				c->i, NULL);
+		_ender_parser_link_name_set(c->parser, l, value);
 	}
 	else
 	{
@@ -456,25 +807,19 @@ static Eina_Bool _ender_parser_arg_ctor(Ender_Parser_Context *c)
 		return EINA_FALSE;
 	}
 	c->i = ender_item_arg_new();
+	/* the arg is added to the function once its type is known */
+	c->prv = _ender_parser_link_add(c->parser, ENDER_PARSER_LINK_ARG, c->i,
+			parent->i);
 
 	return EINA_TRUE;
 }
 
-static void _ender_parser_arg_dtor(Ender_Parser_Context *c)
-{
-	Ender_Parser_Context *parent;
-
-	/* add the arg to the function */
-	parent = _ender_parser_parent_context_get(c->parser);
-	ender_item_function_arg_add(parent->i, ender_item_ref(c->i));
-}
-
 static Eina_Bool _ender_parser_arg_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
-	if (_ender_parser_item_attrs_set(c, key, value))
+	if (_ender_parser_item_attrs_set(c, attr, value))
 		return EINA_TRUE;
-	else if (!strcmp(key, "direction"))
+	else if (attr == ENDER_PARSER_ATTR_DIRECTION)
 	{
 		Ender_Item_Arg_Direction dir = ENDER_ITEM_ARG_DIRECTION_IN;
 
@@ -490,19 +835,11 @@ static Eina_Bool _ender_parser_arg_attrs_set(Ender_Parser_Context *c,
 		}
 		ender_item_arg_direction_set(c->i, dir); 
 	}
-	else if (!strcmp(key, "type"))
+	else if (attr == ENDER_PARSER_ATTR_TYPE)
 	{
-		Ender_Item *type;
-
-		type = ender_lib_item_find(c->parser->lib, value);
-		if (!type)
-		{
-			ERR("Can not find type '%s'", value);
-			return EINA_FALSE;
-		}
-		ender_item_arg_type_set(c->i, type);
+		_ender_parser_link_name_set(c->parser, c->prv, value);
 	}
-	else if (!strcmp(key, "transfer"))
+	else if (attr == ENDER_PARSER_ATTR_TRANSFER)
 	{
 		Ender_Item_Transfer xfer = ENDER_ITEM_TRANSFER_FULL;
 
@@ -520,6 +857,16 @@ static Eina_Bool _ender_parser_arg_attrs_set(Ender_Parser_Context *c,
 		}
 		ender_item_arg_transfer_set(c->i, xfer);
 	}
+	else if (attr == ENDER_PARSER_ATTR_BY_VALUE)
+	{
+		if (!strcmp(value, "true"))
+		{
+			int flags;
+
+			flags = ender_item_arg_flags_get(c->i);
+			ender_item_arg_flags_set(c->i, flags | ENDER_ITEM_ARG_FLAG_BY_VALUE);
+		}
+	}
 	else
 	{
 		return EINA_FALSE;
@@ -542,8 +889,9 @@ static Eina_Bool _ender_parser_return_ctor(Ender_Parser_Context *c)
 	}
 	c->i = ender_item_arg_new();
 	ender_item_arg_flags_set(c->i, ENDER_ITEM_ARG_FLAG_IS_RETURN);
+	c->prv = _ender_parser_link_add(c->parser, ENDER_PARSER_LINK_ARG, c->i,
+			NULL);
 	/* add the return to the function */
-	parent = _ender_parser_parent_context_get(c->parser);
 	ender_item_function_ret_set(parent->i, ender_item_ref(c->i));
 
 	return EINA_TRUE;
@@ -554,23 +902,15 @@ static void _ender_parser_return_dtor(Ender_Parser_Context *c)
 }
 
 static Eina_Bool _ender_parser_return_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
-	if (_ender_parser_item_attrs_set(c, key, value))
+	if (_ender_parser_item_attrs_set(c, attr, value))
 		return EINA_TRUE;
-	else if (!strcmp(key, "type"))
+	else if (attr == ENDER_PARSER_ATTR_TYPE)
 	{
-		Ender_Item *type;
-
-		type = ender_lib_item_find(c->parser->lib, value);
-		if (!type)
-		{
-			ERR("Can not find type '%s'", value);
-			return EINA_FALSE;
-		}
-		ender_item_arg_type_set(c->i, type);
+		_ender_parser_link_name_set(c->parser, c->prv, value);
 	}
-	else if (!strcmp(key, "transfer"))
+	else if (attr == ENDER_PARSER_ATTR_TRANSFER)
 	{
 		Ender_Item_Transfer xfer = ENDER_ITEM_TRANSFER_FULL;
 
@@ -588,6 +928,16 @@ static Eina_Bool _ender_parser_return_attrs_set(Ender_Parser_Context *c,
 		}
 		ender_item_arg_transfer_set(c->i, xfer);
 	}
+	else if (attr == ENDER_PARSER_ATTR_BY_VALUE)
+	{
+		if (!strcmp(value, "true"))
+		{
+			int flags;
+
+			flags = ender_item_arg_flags_get(c->i);
+			ender_item_arg_flags_set(c->i, flags | ENDER_ITEM_ARG_FLAG_BY_VALUE);
+		}
+	}
 	else
 	{
 		return EINA_FALSE;
@@ -623,7 +973,8 @@ static Eina_Bool _ender_parser_setter_ctor(Ender_Parser_Context *c)
 	}
 
 	/* our private context */
-	thiz = calloc(1, sizeof(Ender_Parser_Function));
+	thiz = _ender_parser_arena_alloc(&c->parser->arena,
+			sizeof(Ender_Parser_Function));
 	c->prv = thiz;
 	c->i = ender_item_function_new();
 	ender_item_name_set(c->i, "set");
@@ -643,9 +994,9 @@ static void _ender_parser_setter_dtor(Ender_Parser_Context *c)
 }
 
 static Eina_Bool _ender_parser_setter_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
-	if (_ender_parser_common_function_attrs_set(c, key, value))
+	if (_ender_parser_common_function_attrs_set(c, attr, value))
 		return EINA_TRUE;
 	else
 	{
@@ -682,29 +1033,28 @@ static Eina_Bool _ender_parser_getter_ctor(Ender_Parser_Context *c)
 	}
 
 	/* our private context */
-	thiz = calloc(1, sizeof(Ender_Parser_Function));
+	thiz = _ender_parser_arena_alloc(&c->parser->arena,
+			sizeof(Ender_Parser_Function));
 	c->prv = thiz;
 	c->i = ender_item_function_new();
 	ender_item_name_set(c->i, "get");
 	ender_item_function_flags_set(c->i, ENDER_ITEM_FUNCTION_FLAG_IS_METHOD);
+	/* set it as getter once its args are known */
+	_ender_parser_link_add(c->parser, ENDER_PARSER_LINK_GETTER, c->i,
+			parent->i);
 
 	return EINA_TRUE;
 }
 
 static void _ender_parser_getter_dtor(Ender_Parser_Context *c)
 {
-	Ender_Parser_Context *parent;
-
-	/* set it as getter */
-	parent = _ender_parser_parent_context_get(c->parser);
-	ender_item_attr_getter_set(parent->i, ender_item_ref(c->i));
 	_ender_parser_common_function_dtor(c);
 }
 
 static Eina_Bool _ender_parser_getter_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
-	if (_ender_parser_common_function_attrs_set(c, key, value))
+	if (_ender_parser_common_function_attrs_set(c, attr, value))
 		return EINA_TRUE;
 	else
 	{
@@ -741,7 +1091,8 @@ static Eina_Bool _ender_parser_method_ctor(Ender_Parser_Context *c)
 	}
 
 	/* our private context */
-	thiz = calloc(1, sizeof(Ender_Parser_Field));
+	thiz = _ender_parser_arena_alloc(&c->parser->arena,
+			sizeof(Ender_Parser_Function));
 	c->prv = thiz;
 	c->i = ender_item_function_new();
 
@@ -781,9 +1132,9 @@ static void _ender_parser_method_dtor(Ender_Parser_Context *c)
 }
 
 static Eina_Bool _ender_parser_method_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
-	if (_ender_parser_common_function_attrs_set(c, key, value))
+	if (_ender_parser_common_function_attrs_set(c, attr, value))
 		return EINA_TRUE;
 	else
 	{
@@ -810,9 +1161,9 @@ static void _ender_parser_ctor_dtor(Ender_Parser_Context *c)
 }
 
 static Eina_Bool _ender_parser_ctor_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
-	if (_ender_parser_common_function_attrs_set(c, key, value))
+	if (_ender_parser_common_function_attrs_set(c, attr, value))
 		return EINA_TRUE;
 	else
 	{
@@ -831,6 +1182,8 @@ static Eina_Bool _ender_parser_ref_ctor(Ender_Parser_Context *c)
 
 	ender_item_function_flags_set(c->i, ENDER_ITEM_FUNCTION_FLAG_IS_METHOD
 			| ENDER_ITEM_FUNCTION_FLAG_REF);
+	/* the name is optional */
+	ender_item_name_set(c->i, "ref");
 
 	return EINA_TRUE;
 }
@@ -841,9 +1194,9 @@ static void _ender_parser_ref_dtor(Ender_Parser_Context *c)
 }
 
 static Eina_Bool _ender_parser_ref_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
-	if (_ender_parser_common_function_attrs_set(c, key, value))
+	if (_ender_parser_common_function_attrs_set(c, attr, value))
 		return EINA_TRUE;
 	else
 	{
@@ -861,6 +1214,8 @@ static Eina_Bool _ender_parser_unref_ctor(Ender_Parser_Context *c)
 
 	ender_item_function_flags_set(c->i, ENDER_ITEM_FUNCTION_FLAG_IS_METHOD
 			| ENDER_ITEM_FUNCTION_FLAG_UNREF);
+	/* the name is optional */
+	ender_item_name_set(c->i, "unref");
 
 	return EINA_TRUE;
 }
@@ -871,9 +1226,9 @@ static void _ender_parser_unref_dtor(Ender_Parser_Context *c)
 }
 
 static Eina_Bool _ender_parser_unref_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
-	if (_ender_parser_common_function_attrs_set(c, key, value))
+	if (_ender_parser_common_function_attrs_set(c, attr, value))
 		return EINA_TRUE;
 	else
 	{
@@ -905,7 +1260,8 @@ static Eina_Bool _ender_parser_value_ctor(Ender_Parser_Context *c)
 	}
 
 	/* our own private data */
-	thiz = calloc(1, sizeof(Ender_Parser_Value));
+	thiz = _ender_parser_arena_alloc(&c->parser->arena,
+			sizeof(Ender_Parser_Value));
 
 	c->i = ender_item_constant_new();
 	c->prv = thiz;
@@ -928,7 +1284,6 @@ static void _ender_parser_value_dtor(Ender_Parser_Context *c)
 	{
 		/* TODO parse the value */
 		WRN("TODO");
-		free(thiz->value);
 	}
 	else
 	{
@@ -956,20 +1311,19 @@ static void _ender_parser_value_dtor(Ender_Parser_Context *c)
 			ender_item_unref(i);
 	}
 	ender_item_enum_value_add(parent->i, ender_item_ref(c->i));
-	free(thiz);
 }
 
 static Eina_Bool _ender_parser_value_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
 	Ender_Parser_Value *thiz;
 	
 	thiz = c->prv;
-	if (_ender_parser_item_attrs_set(c, key, value))
+	if (_ender_parser_item_attrs_set(c, attr, value))
 		return EINA_TRUE;
-	else if (!strcmp(key, "value"))
+	else if (attr == ENDER_PARSER_ATTR_VALUE)
 	{
-		thiz->value = strdup(value);
+		thiz->value = _ender_parser_arena_strdup(&c->parser->arena, value);
 	}
 	else
 	{
@@ -1002,9 +1356,9 @@ static void _ender_parser_enum_dtor(Ender_Parser_Context *c)
 }
 
 static Eina_Bool _ender_parser_enum_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
-	if (!strcmp(key, "name"))
+	if (attr == ENDER_PARSER_ATTR_NAME)
 	{
 		ender_item_name_set(c->i, value);
 		ender_lib_item_add(c->parser->lib, ender_item_ref(c->i));
@@ -1020,7 +1374,6 @@ static Eina_Bool _ender_parser_enum_attrs_set(Ender_Parser_Context *c,
  *----------------------------------------------------------------------------*/
 static Eina_Bool _ender_parser_prop_ctor(Ender_Parser_Context *c)
 {
-	Ender_Parser_Field *f;
 	Ender_Parser_Context *parent;
 	Ender_Item_Type type;
 
@@ -1044,10 +1397,10 @@ static Eina_Bool _ender_parser_prop_ctor(Ender_Parser_Context *c)
 		return EINA_FALSE;
 	}
 
-	/* our private context */
-	f = calloc(1, sizeof(Ender_Parser_Field));
-	c->prv = f;
 	c->i = ender_item_attr_new();
+	/* the type is set once the lib is complete */
+	c->prv = _ender_parser_link_add(c->parser, ENDER_PARSER_LINK_PROP, c->i,
+			NULL);
 
 	/* add the prop */
 	ender_item_object_prop_add(parent->i, ender_item_ref(c->i));
@@ -1055,43 +1408,16 @@ static Eina_Bool _ender_parser_prop_ctor(Ender_Parser_Context *c)
 	return EINA_TRUE;
 }
 
-static void _ender_parser_prop_dtor(Ender_Parser_Context *c)
-{
-	Ender_Parser_Field *prop = c->prv;
-
-	/* set the type in case it is set */
-	if (prop->type)
-	{
-		Ender_Item *i;
-		i = ender_lib_item_find(c->parser->lib, prop->type);
-		if (!i)
-		{
-			ERR("Can not find type '%s'", prop->type);
-			goto done;
-		}
-		ender_item_attr_type_set(c->i, i);
-	}
-
-done:
-	/* free our private context */
-	if (prop->type)
-		free(prop->type);
-	free(prop);
-	c->prv = NULL;
-}
-
 static Eina_Bool _ender_parser_prop_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
-	Ender_Parser_Field *f = c->prv;
-
-	if (_ender_parser_item_attrs_set(c, key, value))
+	if (_ender_parser_item_attrs_set(c, attr, value))
 		return EINA_TRUE;
-	else if (!strcmp(key, "type"))
+	else if (attr == ENDER_PARSER_ATTR_TYPE)
 	{
-		f->type = strdup(value);
+		_ender_parser_link_name_set(c->parser, c->prv, value);
 	}
-	else if (!strcmp(key, "value-of"))
+	else if (attr == ENDER_PARSER_ATTR_VALUE_OF)
 	{
 		if (!strcmp(value, "true"))
 		{
@@ -1101,7 +1427,7 @@ static Eina_Bool _ender_parser_prop_attrs_set(Ender_Parser_Context *c,
 			ender_item_attr_flags_set(c->i, flags | ENDER_ITEM_ATTR_FLAG_VALUE_OF);
 		}
 	}
-	else if (!strcmp(key, "downcast"))
+	else if (attr == ENDER_PARSER_ATTR_DOWNCAST)
 	{
 		if (!strcmp(value, "true"))
 		{
@@ -1123,7 +1449,6 @@ static Eina_Bool _ender_parser_prop_attrs_set(Ender_Parser_Context *c,
  *----------------------------------------------------------------------------*/
 static Eina_Bool _ender_parser_field_ctor(Ender_Parser_Context *c)
 {
-	Ender_Parser_Field *f;
 	Ender_Parser_Context *parent;
 	Ender_Item_Type type;
 
@@ -1140,50 +1465,24 @@ static Eina_Bool _ender_parser_field_ctor(Ender_Parser_Context *c)
 		return EINA_FALSE;
 	}
 
-	/* our private context */
-	f = calloc(1, sizeof(Ender_Parser_Field));
-	c->prv = f;
 	c->i = ender_item_attr_new();
+	/* the field is added to the struct once its type is known, the layout
+	 * depends on it
+	 */
+	c->prv = _ender_parser_link_add(c->parser, ENDER_PARSER_LINK_FIELD, c->i,
+			parent->i);
 
 	return EINA_TRUE;
 }
 
-static void _ender_parser_field_dtor(Ender_Parser_Context *c)
-{
-	Ender_Parser_Context *parent;
-	Ender_Parser_Field *field = c->prv;
-	Ender_Item *i;
-
-	/* set the type */
-	i = ender_lib_item_find(c->parser->lib, field->type);
-	if (!i)
-	{
-		ERR("Can not find type '%s'", field->type);
-		goto done;
-	}
-	ender_item_attr_type_set(c->i, i);
-
-	/* add the field */
-	parent = _ender_parser_parent_context_get(c->parser);
-	ender_item_struct_field_add(parent->i, ender_item_ref(c->i));
-done:
-	/* free our private context */
-	if (field->type)
-		free(field->type);
-	free(field);
-	c->prv = NULL;
-}
-
 static Eina_Bool _ender_parser_field_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
-	Ender_Parser_Field *f = c->prv;
-
-	if (_ender_parser_item_attrs_set(c, key, value))
+	if (_ender_parser_item_attrs_set(c, attr, value))
 		return EINA_TRUE;
-	else if (!strcmp(key, "type"))
+	else if (attr == ENDER_PARSER_ATTR_TYPE)
 	{
-		f->type = strdup(value);
+		_ender_parser_link_name_set(c->parser, c->prv, value);
 	}
 	else
 	{
@@ -1207,13 +1506,16 @@ static Eina_Bool _ender_parser_lib_ctor(Ender_Parser_Context *c)
 
 static void _ender_parser_lib_dtor(Ender_Parser_Context *c)
 {
+	_ender_parser_link(c->parser);
+	if (c->parser->keep)
+		return;
 	ender_lib_register(c->parser->lib);
 }
 
 static Eina_Bool _ender_parser_lib_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
-	if (!strcmp(key, "case"))
+	if (attr == ENDER_PARSER_ATTR_CASE)
 	{
 		if (!strcmp(value, "underscore"))
 			c->parser->lcase = ENDER_CASE_UNDERSCORE;
@@ -1223,7 +1525,7 @@ static Eina_Bool _ender_parser_lib_attrs_set(Ender_Parser_Context *c,
 			c->parser->lcase = ENDER_CASE_PASCAL;
 		ender_lib_case_set(c->parser->lib, c->parser->lcase);
 	}
-	else if (!strcmp(key, "notation"))
+	else if (attr == ENDER_PARSER_ATTR_NOTATION)
 	{
 		Ender_Notation notation = ENDER_NOTATION_LATIN;
 
@@ -1233,11 +1535,11 @@ static Eina_Bool _ender_parser_lib_attrs_set(Ender_Parser_Context *c,
 			notation = ENDER_NOTATION_LATIN;
 		ender_lib_notation_set(c->parser->lib, notation);
 	}
-	else if (!strcmp(key, "name"))
+	else if (attr == ENDER_PARSER_ATTR_NAME)
 	{
 		ender_lib_name_set(c->parser->lib, value);
 	}
-	else if (!strcmp(key, "version"))
+	else if (attr == ENDER_PARSER_ATTR_VERSION)
 	{
 		int version = atoi(value);
 		ender_lib_version_set(c->parser->lib, version);
@@ -1251,33 +1553,22 @@ static Eina_Bool _ender_parser_include_ctor(Ender_Parser_Context *c)
 }
 
 static Eina_Bool _ender_parser_include_attrs_set(Ender_Parser_Context *c,
-		const char *key, const char *value)
+		Ender_Parser_Attr attr, const char *value)
 {
-	if (!strcmp(key, "name"))
+	if (attr == ENDER_PARSER_ATTR_NAME)
 	{
 		const Ender_Lib *dep;
 
-		dep = ender_lib_find(value);
-		if (!dep)
-		{
-			char *file = NULL;
-			FILE *f;
-
-			if (asprintf(&file, "%s/%s.ender", DESCRIPTIONS_DIR, value) < 0)
-				return EINA_FALSE;
-
-			f = fopen(file, "r");
-			DBG("Including %s %p", file, f);
-			ender_parser_parse(f);
-			fclose(f);
-			free(file);
-
-			dep = ender_lib_find(value);
-		}
+		/* the registry is already locked */
+		dep = ender_lib_description_load(value);
 		if (dep)
 		{
 			ender_lib_dependency_add(c->parser->lib, dep);
 		}
+		else
+		{
+			WRN("Included library '%s' not found", value);
+		}
 	}
 	else
 	{
@@ -1286,44 +1577,228 @@ static Eina_Bool _ender_parser_include_attrs_set(Ender_Parser_Context *c,
 	return EINA_TRUE;
 }
 
-static Ender_Parser_Tag _tags[] = {
-	{ "lib", _ender_parser_lib_ctor, _ender_parser_lib_dtor, _ender_parser_lib_attrs_set },
-	{ "type", NULL, NULL, NULL },
-	{ "include", _ender_parser_include_ctor, NULL, _ender_parser_include_attrs_set },
-	{ "def", _ender_parser_def_ctor, NULL, _ender_parser_def_attrs_set },
-	{ "object", _ender_parser_object_ctor, _ender_parser_object_dtor, _ender_parser_object_attrs_set },
-	{ "struct", _ender_parser_struct_ctor, NULL, _ender_parser_struct_attrs_set },
-	{ "enum", _ender_parser_enum_ctor, _ender_parser_enum_dtor, _ender_parser_enum_attrs_set },
-	{ "value", _ender_parser_value_ctor, _ender_parser_value_dtor, _ender_parser_value_attrs_set },
-	{ "field", _ender_parser_field_ctor, _ender_parser_field_dtor, _ender_parser_field_attrs_set },
-	{ "prop", _ender_parser_prop_ctor, _ender_parser_prop_dtor, _ender_parser_prop_attrs_set },
-	{ "method", _ender_parser_method_ctor, _ender_parser_method_dtor, _ender_parser_method_attrs_set },
-	{ "getter", _ender_parser_getter_ctor, _ender_parser_getter_dtor, _ender_parser_getter_attrs_set },
-	{ "setter", _ender_parser_setter_ctor, _ender_parser_setter_dtor, _ender_parser_setter_attrs_set },
-	{ "function", _ender_parser_function_ctor, _ender_parser_function_dtor, _ender_parser_function_attrs_set },
-	{ "ctor", _ender_parser_ctor_ctor, _ender_parser_ctor_dtor, _ender_parser_ctor_attrs_set },
-	{ "ref", _ender_parser_ref_ctor, _ender_parser_ref_dtor, _ender_parser_ref_attrs_set },
-	{ "unref", _ender_parser_unref_ctor, _ender_parser_unref_dtor, _ender_parser_unref_attrs_set },
-	{ "arg", _ender_parser_arg_ctor, _ender_parser_arg_dtor, _ender_parser_arg_attrs_set },
-	{ "return", _ender_parser_return_ctor, _ender_parser_return_dtor, _ender_parser_return_attrs_set },
-	{ "class", NULL, NULL, NULL },
+typedef enum _Ender_Parser_Tag_Id
+{
+	ENDER_PARSER_TAG_LIB,
+	ENDER_PARSER_TAG_TYPE,
+	ENDER_PARSER_TAG_INCLUDE,
+	ENDER_PARSER_TAG_DEF,
+	ENDER_PARSER_TAG_OBJECT,
+	ENDER_PARSER_TAG_STRUCT,
+	ENDER_PARSER_TAG_ENUM,
+	ENDER_PARSER_TAG_VALUE,
+	ENDER_PARSER_TAG_FIELD,
+	ENDER_PARSER_TAG_PROP,
+	ENDER_PARSER_TAG_METHOD,
+	ENDER_PARSER_TAG_GETTER,
+	ENDER_PARSER_TAG_SETTER,
+	ENDER_PARSER_TAG_FUNCTION,
+	ENDER_PARSER_TAG_CALLBACK,
+	ENDER_PARSER_TAG_CTOR,
+	ENDER_PARSER_TAG_REF,
+	ENDER_PARSER_TAG_UNREF,
+	ENDER_PARSER_TAG_ARG,
+	ENDER_PARSER_TAG_RETURN,
+	ENDER_PARSER_TAG_CLASS,
+	ENDER_PARSER_TAGS,
+} Ender_Parser_Tag_Id;
+
+static Ender_Parser_Tag _tags[ENDER_PARSER_TAGS] = {
+	[ENDER_PARSER_TAG_LIB] = { "lib", _ender_parser_lib_ctor, _ender_parser_lib_dtor, _ender_parser_lib_attrs_set },
+	[ENDER_PARSER_TAG_TYPE] = { "type", NULL, NULL, NULL },
+	[ENDER_PARSER_TAG_INCLUDE] = { "include", _ender_parser_include_ctor, NULL, _ender_parser_include_attrs_set },
+	[ENDER_PARSER_TAG_DEF] = { "def", _ender_parser_def_ctor, NULL, _ender_parser_def_attrs_set },
+	[ENDER_PARSER_TAG_OBJECT] = { "object", _ender_parser_object_ctor, _ender_parser_object_dtor, _ender_parser_object_attrs_set },
+	[ENDER_PARSER_TAG_STRUCT] = { "struct", _ender_parser_struct_ctor, NULL, _ender_parser_struct_attrs_set },
+	[ENDER_PARSER_TAG_ENUM] = { "enum", _ender_parser_enum_ctor, _ender_parser_enum_dtor, _ender_parser_enum_attrs_set },
+	[ENDER_PARSER_TAG_VALUE] = { "value", _ender_parser_value_ctor, _ender_parser_value_dtor, _ender_parser_value_attrs_set },
+	[ENDER_PARSER_TAG_FIELD] = { "field", _ender_parser_field_ctor, NULL, _ender_parser_field_attrs_set },
+	[ENDER_PARSER_TAG_PROP] = { "prop", _ender_parser_prop_ctor, NULL, _ender_parser_prop_attrs_set },
+	[ENDER_PARSER_TAG_METHOD] = { "method", _ender_parser_method_ctor, _ender_parser_method_dtor, _ender_parser_method_attrs_set },
+	[ENDER_PARSER_TAG_GETTER] = { "getter", _ender_parser_getter_ctor, _ender_parser_getter_dtor, _ender_parser_getter_attrs_set },
+	[ENDER_PARSER_TAG_SETTER] = { "setter", _ender_parser_setter_ctor, _ender_parser_setter_dtor, _ender_parser_setter_attrs_set },
+	[ENDER_PARSER_TAG_FUNCTION] = { "function", _ender_parser_function_ctor, _ender_parser_function_dtor, _ender_parser_function_attrs_set },
+	[ENDER_PARSER_TAG_CALLBACK] = { "callback", _ender_parser_callback_ctor, NULL, _ender_parser_callback_attrs_set },
+	[ENDER_PARSER_TAG_CTOR] = { "ctor", _ender_parser_ctor_ctor, _ender_parser_ctor_dtor, _ender_parser_ctor_attrs_set },
+	[ENDER_PARSER_TAG_REF] = { "ref", _ender_parser_ref_ctor, _ender_parser_ref_dtor, _ender_parser_ref_attrs_set },
+	[ENDER_PARSER_TAG_UNREF] = { "unref", _ender_parser_unref_ctor, _ender_parser_unref_dtor, _ender_parser_unref_attrs_set },
+	[ENDER_PARSER_TAG_ARG] = { "arg", _ender_parser_arg_ctor, NULL, _ender_parser_arg_attrs_set },
+	[ENDER_PARSER_TAG_RETURN] = { "return", _ender_parser_return_ctor, _ender_parser_return_dtor, _ender_parser_return_attrs_set },
+	[ENDER_PARSER_TAG_CLASS] = { "class", NULL, NULL, NULL },
+};
+
+static const char *_attrs[] = {
+	[ENDER_PARSER_ATTR_UNKNOWN] = "",
+	[ENDER_PARSER_ATTR_NAME] = "name",
+	[ENDER_PARSER_ATTR_TYPE] = "type",
+	[ENDER_PARSER_ATTR_CASE] = "case",
+	[ENDER_PARSER_ATTR_VALUE] = "value",
+	[ENDER_PARSER_ATTR_SYMNAME] = "symname",
+	[ENDER_PARSER_ATTR_VERSION] = "version",
+	[ENDER_PARSER_ATTR_INHERITS] = "inherits",
+	[ENDER_PARSER_ATTR_TRANSFER] = "transfer",
+	[ENDER_PARSER_ATTR_BY_VALUE] = "by-value",
+	[ENDER_PARSER_ATTR_VALUE_OF] = "value-of",
+	[ENDER_PARSER_ATTR_DOWNCAST] = "downcast",
+	[ENDER_PARSER_ATTR_NOTATION] = "notation",
+	[ENDER_PARSER_ATTR_DIRECTION] = "direction",
 };
 
-static Ender_Parser_Tag * _ender_parser_get_tag(const char *name)
+/* The length of the tag name the content starts with */
+static unsigned int _ender_parser_tag_length(const char *content,
+		unsigned int length)
+{
+	unsigned int i;
+
+	for (i = 0; i < length; i++)
+	{
+		if (isspace((unsigned char)content[i]) || content[i] == '/' ||
+				content[i] == '>')
+			break;
+	}
+	return i;
+}
+
+/* The tags are matched by their length and first char, this way only one
+ * candidate is compared. A new tag must be added here too
+ */
+static Ender_Parser_Tag * _ender_parser_get_tag(const char *name,
+		unsigned int length)
 {
-	Ender_Parser_Tag *ret = NULL;
-	int i;
+	Ender_Parser_Tag_Id id;
 
-	for (i = 0; i < sizeof(_tags) / sizeof(Ender_Parser_Tag); i++)
+	switch (length)
 	{
-		Ender_Parser_Tag *t = &_tags[i];
-		if (!strncmp(name, t->name, strlen(t->name)))
+		case 3:
+		switch (name[0])
 		{
-			ret = t;
+			case 'l': id = ENDER_PARSER_TAG_LIB; break;
+			case 'd': id = ENDER_PARSER_TAG_DEF; break;
+			case 'r': id = ENDER_PARSER_TAG_REF; break;
+			case 'a': id = ENDER_PARSER_TAG_ARG; break;
+			default: return NULL;
+		}
+		break;
+
+		case 4:
+		switch (name[0])
+		{
+			case 't': id = ENDER_PARSER_TAG_TYPE; break;
+			case 'e': id = ENDER_PARSER_TAG_ENUM; break;
+			case 'p': id = ENDER_PARSER_TAG_PROP; break;
+			case 'c': id = ENDER_PARSER_TAG_CTOR; break;
+			default: return NULL;
+		}
+		break;
+
+		case 5:
+		switch (name[0])
+		{
+			case 'v': id = ENDER_PARSER_TAG_VALUE; break;
+			case 'f': id = ENDER_PARSER_TAG_FIELD; break;
+			case 'u': id = ENDER_PARSER_TAG_UNREF; break;
+			case 'c': id = ENDER_PARSER_TAG_CLASS; break;
+			default: return NULL;
+		}
+		break;
+
+		case 6:
+		switch (name[0])
+		{
+			case 'o': id = ENDER_PARSER_TAG_OBJECT; break;
+			case 'm': id = ENDER_PARSER_TAG_METHOD; break;
+			case 'g': id = ENDER_PARSER_TAG_GETTER; break;
+			case 'r': id = ENDER_PARSER_TAG_RETURN; break;
+			/* struct and setter */
+			case 's':
+			id = name[1] == 't' ? ENDER_PARSER_TAG_STRUCT :
+					ENDER_PARSER_TAG_SETTER;
 			break;
+			default: return NULL;
 		}
+		break;
+
+		case 7:
+		id = ENDER_PARSER_TAG_INCLUDE;
+		break;
+
+		case 8:
+		switch (name[0])
+		{
+			case 'f': id = ENDER_PARSER_TAG_FUNCTION; break;
+			case 'c': id = ENDER_PARSER_TAG_CALLBACK; break;
+			/* the descriptions generated by older versions of
+			 * fromdoxygen use includes
+			 */
+			case 'i':
+			if (memcmp(name, "includes", length))
+				return NULL;
+			return &_tags[ENDER_PARSER_TAG_INCLUDE];
+			default: return NULL;
+		}
+		break;
+
+		default:
+		return NULL;
 	}
-	return ret;
+	if (memcmp(name, _tags[id].name, length))
+		return NULL;
+	return &_tags[id];
+}
+
+/* The attributes are matched the same way */
+static Ender_Parser_Attr _ender_parser_get_attr(const char *key)
+{
+	Ender_Parser_Attr attr;
+
+	switch (strlen(key))
+	{
+		case 4:
+		switch (key[0])
+		{
+			case 'n': attr = ENDER_PARSER_ATTR_NAME; break;
+			case 't': attr = ENDER_PARSER_ATTR_TYPE; break;
+			case 'c': attr = ENDER_PARSER_ATTR_CASE; break;
+			default: return ENDER_PARSER_ATTR_UNKNOWN;
+		}
+		break;
+
+		case 5:
+		attr = ENDER_PARSER_ATTR_VALUE;
+		break;
+
+		case 7:
+		switch (key[0])
+		{
+			case 's': attr = ENDER_PARSER_ATTR_SYMNAME; break;
+			case 'v': attr = ENDER_PARSER_ATTR_VERSION; break;
+			default: return ENDER_PARSER_ATTR_UNKNOWN;
+		}
+		break;
+
+		case 8:
+		switch (key[0])
+		{
+			case 'i': attr = ENDER_PARSER_ATTR_INHERITS; break;
+			case 't': attr = ENDER_PARSER_ATTR_TRANSFER; break;
+			case 'b': attr = ENDER_PARSER_ATTR_BY_VALUE; break;
+			case 'v': attr = ENDER_PARSER_ATTR_VALUE_OF; break;
+			case 'd': attr = ENDER_PARSER_ATTR_DOWNCAST; break;
+			case 'n': attr = ENDER_PARSER_ATTR_NOTATION; break;
+			default: return ENDER_PARSER_ATTR_UNKNOWN;
+		}
+		break;
+
+		case 9:
+		attr = ENDER_PARSER_ATTR_DIRECTION;
+		break;
+
+		default:
+		return ENDER_PARSER_ATTR_UNKNOWN;
+	}
+	if (strcmp(key, _attrs[attr]))
+		return ENDER_PARSER_ATTR_UNKNOWN;
+	return attr;
 }
 
 static Eina_Bool _ender_parser_attrs_set_cb(void *data, const char *key,
@@ -1334,7 +1809,7 @@ static Eina_Bool _ender_parser_attrs_set_cb(void *data, const char *key,
 	if (!c->tag) return EINA_FALSE;
 	if (c->tag->attrs_set_cb)
 	{
-		return c->tag->attrs_set_cb(c, key, value); 
+		return c->tag->attrs_set_cb(c, _ender_parser_get_attr(key), value);
 	}
 	return EINA_FALSE;
 }
@@ -1345,10 +1820,13 @@ static Eina_Bool _ender_parser_attrs_set_cb(void *data, const char *key,
 static Ender_Parser_Context * _ender_parser_tag_new(Ender_Parser *thiz,
 		const char *content, unsigned int length)
 {
+	Ender_Parser_Arena_Mark mark;
 	Ender_Parser_Context *c;
 	const char *attrs = NULL;
 
-	c = calloc(1, sizeof(Ender_Parser_Context));
+	mark = _ender_parser_arena_mark(&thiz->arena);
+	c = _ender_parser_arena_alloc(&thiz->arena, sizeof(Ender_Parser_Context));
+	c->mark = mark;
 	c->parser = thiz;
 
 	/* if the parser has failed, keep failing */
@@ -1358,15 +1836,20 @@ static Ender_Parser_Context * _ender_parser_tag_new(Ender_Parser *thiz,
 		goto done;
 	}
 
-	c->tag = _ender_parser_get_tag(content);
+	c->tag = _ender_parser_get_tag(content,
+			_ender_parser_tag_length(content, length));
 	if (c->tag)
 	{
 		if (c->tag->ctor_cb)
 		{
 			if (c->tag->ctor_cb(c))
 			{
+				/* the attributes end where the tag does */
 				attrs = eina_simple_xml_tag_attributes_find(content, length);
-				eina_simple_xml_attributes_parse(attrs, length, _ender_parser_attrs_set_cb, c);
+				if (attrs)
+					eina_simple_xml_attributes_parse(attrs,
+							length - (attrs - content),
+							_ender_parser_attrs_set_cb, c);
 			}
 			else
 			{
@@ -1401,18 +1884,19 @@ static void _ender_parser_context_free(Ender_Parser_Context *c)
 		}
 		if (c->i)
 		{
-			int cycle_ref;
-
-			cycle_ref = ender_item_ref_count(c->i);
-			/* in case the ref > 1, the item has been included on the lib */
-			if (cycle_ref > 1)
-			{
-				/* every ref() done between the ctor and the dtor *must* be a cycle ref */
-				ender_item_cycle_ref_set(c->i, cycle_ref - 2);
-			}
-			ender_item_unref(c->i);
+			/* in case the ref > 1, the item has been included on the lib,
+			 * the lib owns it from now on no matter the refs done between
+			 * the ctor and the dtor. A reopened item is already owned
+			 */
+			if (c->reopened)
+				ender_item_unref(c->i);
+			else if (ender_item_ref_count(c->i) > 1)
+				ender_lib_item_own(thiz->lib, c->i);
+			else
+				ender_item_unref(c->i);
 		}
-		free(c);
+		/* the context is the first thing allocated for it */
+		_ender_parser_arena_release(&thiz->arena, c->mark);
 	}
 }
 /*----------------------------------------------------------------------------*
@@ -1430,11 +1914,16 @@ static Eina_Bool _ender_parser_parse_cb(void *data, Eina_Simple_XML_Type type,
 		case EINA_SIMPLE_XML_OPEN:
 		c = _ender_parser_tag_new(thiz, content, length);
 		eina_array_push(thiz->context, c);
+		/* stop before adding anything to the item of another lib */
+		if (thiz->deferred)
+			return EINA_FALSE;
 		break;
 
 		case EINA_SIMPLE_XML_OPEN_EMPTY:
 		c = _ender_parser_tag_new(thiz, content, length);
 		_ender_parser_context_free(c);
+		if (thiz->deferred)
+			return EINA_FALSE;
 		break;
 
 		case EINA_SIMPLE_XML_CLOSE:
@@ -1453,52 +1942,501 @@ static Eina_Bool _ender_parser_parse_cb(void *data, Eina_Simple_XML_Type type,
 	}
 	return EINA_TRUE;
 }
+
+static Ender_Parser * _ender_parser_new(Eina_Bool keep)
+{
+	Ender_Parser *thiz;
+
+	thiz = calloc(1, sizeof(Ender_Parser));
+	thiz->context = eina_array_new(1);
+	thiz->links_last = &thiz->links;
+	thiz->keep = keep;
+	return thiz;
+}
+
+/* Finish the parsing. In case some tag is still open, the description is
+ * incomplete and nothing of it is registered
+ */
+static Eina_Bool _ender_parser_free(Ender_Parser *thiz, Ender_Lib **lib)
+{
+	Ender_Parser_Context *c;
+	Eina_Bool ret = EINA_TRUE;
+
+	if (eina_array_count(thiz->context))
+	{
+		if (thiz->deferred)
+			DBG("Description deferred, it extends other libs");
+		else
+			ERR("Incomplete description");
+		/* skip the dtors, the lib is not registered */
+		thiz->failed = eina_array_count(thiz->context) + 1;
+		while ((c = eina_array_pop(thiz->context)))
+			_ender_parser_context_free(c);
+		/* the links refer to items of the lib */
+		_ender_parser_links_free(thiz);
+		if (thiz->lib)
+			ender_lib_free(thiz->lib);
+		thiz->lib = NULL;
+		ret = EINA_FALSE;
+	}
+	if (lib)
+		*lib = thiz->lib;
+	DBG("Parsed with %d arena blocks", thiz->arena.allocs);
+	_ender_parser_arena_cleanup(&thiz->arena);
+	eina_array_free(thiz->context);
+	free(thiz);
+	return ret;
+}
+
+static Eina_Bool _ender_parser_buffer_parse(const char *content, size_t len,
+		Ender_Lib **lib, Eina_Bool *deferred)
+{
+	Ender_Parser *thiz;
+
+	if (!content || !len)
+		return EINA_FALSE;
+
+	thiz = _ender_parser_new(lib ? EINA_TRUE : EINA_FALSE);
+	thiz->concurrent = deferred ? EINA_TRUE : EINA_FALSE;
+	eina_simple_xml_parse(content, len, EINA_TRUE,
+				_ender_parser_parse_cb, thiz);
+	if (deferred)
+		*deferred = thiz->deferred;
+	return _ender_parser_free(thiz, lib);
+}
+
+/* Read a file that can not be mapped, like a pipe */
+static char * _ender_parser_file_read(FILE *f, size_t *len)
+{
+	char *content = NULL;
+	size_t alloc = 0;
+	size_t n;
+
+	*len = 0;
+	do
+	{
+		if (*len == alloc)
+		{
+			alloc = alloc ? alloc * 2 : 4096;
+			content = realloc(content, alloc);
+		}
+		n = fread(content + *len, 1, alloc - *len, f);
+		*len += n;
+	} while (n);
+	if (ferror(f))
+	{
+		free(content);
+		return NULL;
+	}
+	return content;
+}
+
+/* In case a lib is requested it is returned instead of registered */
+static Eina_Bool _ender_parser_parse(FILE *f, Ender_Lib **lib,
+		Eina_Bool *deferred)
+{
+	Eina_Bool ret;
+	struct stat st;
+	void *content;
+	size_t len;
+
+	if (!f) return EINA_FALSE;
+
+	/* map the file */
+	if (!fstat(fileno(f), &st) && S_ISREG(st.st_mode) && st.st_size)
+	{
+		len = st.st_size;
+		content = mmap(NULL, len, PROT_READ, MAP_SHARED, fileno(f), 0);
+		if (content != MAP_FAILED)
+		{
+			ret = _ender_parser_buffer_parse(content, len, lib, deferred);
+			munmap(content, len);
+			return ret;
+		}
+	}
+
+	/* or read it */
+	content = _ender_parser_file_read(f, &len);
+	if (!content)
+	{
+		ERR("Impossible to read the description");
+		return EINA_FALSE;
+	}
+	ret = _ender_parser_buffer_parse(content, len, lib, deferred);
+	free(content);
+	return ret;
+}
+/*----------------------------------------------------------------------------*
+ *                                 stream                                     *
+ *----------------------------------------------------------------------------*/
+/* The data of a stream is parsed up to the end of the last complete markup,
+ * the rest is kept until more data arrives. Only the ends of the markups
+ * need to be found, everything else is left to the XML parser
+ */
+typedef enum _Ender_Parser_Stream_State
+{
+	ENDER_PARSER_STREAM_TEXT,
+	ENDER_PARSER_STREAM_TAG,
+	ENDER_PARSER_STREAM_QUOTE,
+	ENDER_PARSER_STREAM_COMMENT,
+	ENDER_PARSER_STREAM_CDATA,
+} Ender_Parser_Stream_State;
+
+struct _Ender_Parser_Stream
+{
+	Ender_Parser *parser;
+	char *data;
+	size_t len;
+	size_t alloc;
+	/* the bytes already scanned and the end of the last complete markup */
+	size_t scanned;
+	size_t complete;
+	Ender_Parser_Stream_State state;
+	char quote;
+};
+
+/* Check if the data at some position starts with a string, -1 in case there
+ * is not enough data yet
+ */
+static int _ender_parser_stream_match(Ender_Parser_Stream *thiz, size_t pos,
+		const char *str)
+{
+	size_t len = strlen(str);
+	size_t avail = thiz->len - pos;
+
+	if (avail < len)
+		return memcmp(thiz->data + pos, str, avail) ? 0 : -1;
+	return memcmp(thiz->data + pos, str, len) ? 0 : 1;
+}
+
+static void _ender_parser_stream_scan(Ender_Parser_Stream *thiz)
+{
+	size_t i;
+	int m;
+
+	for (i = thiz->scanned; i < thiz->len; i++)
+	{
+		char c = thiz->data[i];
+
+		switch (thiz->state)
+		{
+			case ENDER_PARSER_STREAM_TEXT:
+			if (c != '<')
+				break;
+			if ((m = _ender_parser_stream_match(thiz, i, "<!--")) < 0)
+				goto more;
+			if (m)
+			{
+				thiz->state = ENDER_PARSER_STREAM_COMMENT;
+				i += 3;
+				break;
+			}
+			if ((m = _ender_parser_stream_match(thiz, i, "<![CDATA[")) < 0)
+				goto more;
+			if (m)
+			{
+				thiz->state = ENDER_PARSER_STREAM_CDATA;
+				i += 8;
+				break;
+			}
+			thiz->state = ENDER_PARSER_STREAM_TAG;
+			break;
+
+			case ENDER_PARSER_STREAM_TAG:
+			if (c == '"' || c == '\'')
+			{
+				thiz->quote = c;
+				thiz->state = ENDER_PARSER_STREAM_QUOTE;
+			}
+			else if (c == '>')
+			{
+				thiz->state = ENDER_PARSER_STREAM_TEXT;
+				thiz->complete = i + 1;
+			}
+			break;
+
+			case ENDER_PARSER_STREAM_QUOTE:
+			if (c == thiz->quote)
+				thiz->state = ENDER_PARSER_STREAM_TAG;
+			break;
+
+			case ENDER_PARSER_STREAM_COMMENT:
+			case ENDER_PARSER_STREAM_CDATA:
+			if (c != (thiz->state == ENDER_PARSER_STREAM_COMMENT ? '-' : ']'))
+				break;
+			m = _ender_parser_stream_match(thiz, i,
+					thiz->state == ENDER_PARSER_STREAM_COMMENT ?
+					"-->" : "]]>");
+			if (m < 0)
+				goto more;
+			if (m)
+			{
+				thiz->state = ENDER_PARSER_STREAM_TEXT;
+				i += 2;
+				thiz->complete = i + 1;
+			}
+			break;
+		}
+	}
+more:
+	thiz->scanned = i;
+}
+
+/* Parse the complete markups and keep the rest */
+static void _ender_parser_stream_flush(Ender_Parser_Stream *thiz)
+{
+	if (!thiz->complete)
+		return;
+	ender_lib_registry_lock();
+	eina_simple_xml_parse(thiz->data, thiz->complete, EINA_TRUE,
+			_ender_parser_parse_cb, thiz->parser);
+	ender_lib_registry_unlock();
+	thiz->len -= thiz->complete;
+	thiz->scanned -= thiz->complete;
+	memmove(thiz->data, thiz->data + thiz->complete, thiz->len);
+	thiz->complete = 0;
+}
 /*============================================================================*
  *                                 Global                                     *
  *============================================================================*/
+/* Collect the libraries included by a description file without parsing it,
+ * only the include tags are looked at
+ */
+static Eina_Bool _ender_parser_scan_attrs_cb(void *data, const char *key,
+		const char *value)
+{
+	Eina_List **includes = data;
+
+	if (!strcmp(key, "name"))
+		*includes = eina_list_append(*includes, strdup(value));
+	return EINA_TRUE;
+}
+
+static Eina_Bool _ender_parser_scan_cb(void *data, Eina_Simple_XML_Type type,
+		const char *content, unsigned int offset,
+		unsigned int length)
+{
+	const char *attrs;
+
+	if (type != EINA_SIMPLE_XML_OPEN && type != EINA_SIMPLE_XML_OPEN_EMPTY)
+		return EINA_TRUE;
+	if (_ender_parser_get_tag(content, _ender_parser_tag_length(content,
+			length)) != &_tags[ENDER_PARSER_TAG_INCLUDE])
+		return EINA_TRUE;
+	attrs = eina_simple_xml_tag_attributes_find(content, length);
+	if (!attrs)
+		return EINA_TRUE;
+	eina_simple_xml_attributes_parse(attrs, length - (attrs - content),
+			_ender_parser_scan_attrs_cb, data);
+	return EINA_TRUE;
+}
+
+Eina_List * ender_parser_file_includes_get(const char *file)
+{
+	Eina_List *includes = NULL;
+	struct stat st;
+	void *content;
+	int fd;
+
+	fd = open(file, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	if (fstat(fd, &st) < 0 || !st.st_size)
+	{
+		close(fd);
+		return NULL;
+	}
+	content = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (content == MAP_FAILED)
+		return NULL;
+
+	eina_simple_xml_parse(content, st.st_size, EINA_TRUE,
+			_ender_parser_scan_cb, &includes);
+	munmap(content, st.st_size);
+	return includes;
+}
+
+/* Parse a description file, the registry must be locked. The eager loading
+ * parses several descriptions at the same time without the lock and passes
+ * deferred. Such a parsing only modifies its own lib, it stops before
+ * extending an object of another lib and sets deferred, so the description
+ * is parsed again later with the registry locked
+ */
+Eina_Bool ender_parser_file_parse(const char *file, Eina_Bool *deferred)
+{
+	Eina_Bool ret;
+	FILE *f;
+
+	f = fopen(file, "r");
+	if (!f)
+	{
+		ERR("Impossible to open the file '%s'", file);
+		return EINA_FALSE;
+	}
+	ret = _ender_parser_parse(f, NULL, deferred);
+	fclose(f);
+	return ret;
+}
+
+/* Parse a file without registering its lib. The registry must be locked */
+Ender_Lib * ender_parser_file_lib_parse(const char *file)
+{
+	Ender_Lib *lib = NULL;
+	FILE *f;
+
+	f = fopen(file, "r");
+	if (!f)
+	{
+		ERR("Impossible to open the file '%s'", file);
+		return NULL;
+	}
+	_ender_parser_parse(f, &lib, NULL);
+	fclose(f);
+	return lib;
+}
 /*============================================================================*
  *                                   API                                      *
  *============================================================================*/
 /**
  * Parse a file and register the items on the system
+ *
+ * The parsing is serialized with any other parsing on other threads, but the
+ * registered libraries can be looked up meanwhile. A regular file is mapped,
+ * any other stream, like a pipe, is read until its end.
  * @param f The file to parse
  * @return EINA_TRUE if the call is succesful, EINA_FALSE otherwise
  */
 EAPI Eina_Bool ender_parser_parse(FILE *f)
 {
-	Ender_Parser *thiz;
-	Eina_Bool ret = EINA_FALSE;
-	void *content = NULL;
-	size_t len = 0;
+	Eina_Bool ret;
 
-	if (!f) return EINA_FALSE;
+	ender_lib_registry_lock();
+	ret = _ender_parser_parse(f, NULL, NULL);
+	ender_lib_registry_unlock();
+	return ret;
+}
 
-	/* map the file */
+/**
+ * Parse a file and get the library it describes
+ *
+ * Like @ref ender_parser_parse, but the registered library is returned. The
+ * library is named as the description says, whatever the name of the file.
+ * @param f The file to parse
+ * @return The library described on the file or NULL in case of error
+ */
+EAPI const Ender_Lib * ender_parser_parse_lib(FILE *f)
+{
+	Ender_Lib *lib = NULL;
+
+	ender_lib_registry_lock();
+	/* keep it to register it ourselves */
+	if (!_ender_parser_parse(f, &lib, NULL))
+		lib = NULL;
+	if (lib && !ender_lib_name_get(lib))
 	{
-		int fd;
-		struct stat st;
+		ERR("The library has no name");
+		ender_lib_free(lib);
+		lib = NULL;
+	}
+	if (lib)
+		ender_lib_register(lib);
+	ender_lib_registry_unlock();
+	return lib;
+}
 
-		fd = fileno(f);
-		fstat(fd, &st);
-		len = st.st_size;
+/**
+ * Parse a description on memory and register the items on the system
+ *
+ * Useful for the descriptions embedded on a program. The data is not used
+ * once the function returns.
+ * @param data The description
+ * @param size The size of the description
+ * @return EINA_TRUE if the call is succesful, EINA_FALSE otherwise
+ */
+EAPI Eina_Bool ender_parser_parse_buffer(const void *data, size_t size)
+{
+	Eina_Bool ret;
 
-		content = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
-	}
+	ender_lib_registry_lock();
+	ret = _ender_parser_buffer_parse(data, size, NULL, NULL);
+	ender_lib_registry_unlock();
+	return ret;
+}
 
-	if (!content || !len)
-		return EINA_FALSE;
+/**
+ * Create a parser for a description that arrives in chunks
+ *
+ * The chunks are fed with @ref ender_parser_stream_feed as they arrive, from
+ * a socket or a decompressor for example, and the parsing is finished with
+ * @ref ender_parser_stream_end. Every chunk is parsed as soon as it is fed,
+ * only the incomplete markup at its end is kept.
+ * @return The parser
+ */
+EAPI Ender_Parser_Stream * ender_parser_stream_new(void)
+{
+	Ender_Parser_Stream *thiz;
 
-	thiz = calloc(1, sizeof(Ender_Parser));
-	thiz->context = eina_array_new(1);
-	eina_simple_xml_parse(content, len, EINA_TRUE,
-				_ender_parser_parse_cb, thiz);
+	thiz = calloc(1, sizeof(Ender_Parser_Stream));
+	thiz->parser = _ender_parser_new(EINA_FALSE);
+	return thiz;
+}
+
+/**
+ * Feed a chunk of a description to a parser
+ *
+ * The chunks can be split at any byte.
+ * @param thiz The parser
+ * @param data The chunk
+ * @param size The size of the chunk
+ * @return EINA_TRUE if the call is succesful, EINA_FALSE otherwise
+ */
+EAPI Eina_Bool ender_parser_stream_feed(Ender_Parser_Stream *thiz,
+		const void *data, size_t size)
+{
+	if (!thiz) return EINA_FALSE;
+	if (!size) return EINA_TRUE;
+	if (!data) return EINA_FALSE;
 
-	/* unmap */
-	munmap(content, len);
+	if (thiz->len + size > thiz->alloc)
+	{
+		while (thiz->len + size > thiz->alloc)
+			thiz->alloc = thiz->alloc ? thiz->alloc * 2 : 4096;
+		thiz->data = realloc(thiz->data, thiz->alloc);
+	}
+	memcpy(thiz->data + thiz->len, data, size);
+	thiz->len += size;
+	_ender_parser_stream_scan(thiz);
+	_ender_parser_stream_flush(thiz);
+	return EINA_TRUE;
+}
 
-	ret = EINA_TRUE;
-	eina_array_free(thiz->context);
-	free(thiz);
+/**
+ * Finish the parsing of a description fed in chunks and free the parser
+ *
+ * In case the description is incomplete, nothing of it is registered.
+ * @param thiz The parser
+ * @return EINA_TRUE if the description is complete, EINA_FALSE otherwise
+ */
+EAPI Eina_Bool ender_parser_stream_end(Ender_Parser_Stream *thiz)
+{
+	Eina_Bool ret;
+	size_t i;
+
+	if (!thiz) return EINA_FALSE;
 
+	ret = thiz->state == ENDER_PARSER_STREAM_TEXT ? EINA_TRUE : EINA_FALSE;
+	/* only spaces can be left */
+	for (i = 0; ret && i < thiz->len; i++)
+	{
+		if (!isspace((unsigned char)thiz->data[i]))
+			ret = EINA_FALSE;
+	}
+	ender_lib_registry_lock();
+	if (!_ender_parser_free(thiz->parser, NULL))
+		ret = EINA_FALSE;
+	ender_lib_registry_unlock();
+	free(thiz->data);
+	free(thiz);
 	return ret;
 }
@@ -24,7 +24,20 @@
  * @{
  */
 
+/**
+ * @brief Parser of a description that arrives in chunks
+ * @see ender_parser_stream_new
+ */
+typedef struct _Ender_Parser_Stream Ender_Parser_Stream;
+
 EAPI Eina_Bool ender_parser_parse(FILE *f);
+EAPI const Ender_Lib * ender_parser_parse_lib(FILE *f);
+EAPI Eina_Bool ender_parser_parse_buffer(const void *data, size_t size);
+
+EAPI Ender_Parser_Stream * ender_parser_stream_new(void);
+EAPI Eina_Bool ender_parser_stream_feed(Ender_Parser_Stream *thiz,
+		const void *data, size_t size);
+EAPI Eina_Bool ender_parser_stream_end(Ender_Parser_Stream *thiz);
 
 /**
  * @}
@@ -0,0 +1,26 @@
+/* ENDER - Enesim's descriptor library
+ * Copyright (C) 2010 Jorge Luis Zapata
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ENDER_PARSER_PRIVATE_H_
+#define _ENDER_PARSER_PRIVATE_H_
+
+Eina_Bool ender_parser_file_parse(const char *file, Eina_Bool *deferred);
+Ender_Lib * ender_parser_file_lib_parse(const char *file);
+Eina_List * ender_parser_file_includes_get(const char *file);
+
+#endif
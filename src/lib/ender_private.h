@@ -32,4 +32,15 @@
 
 #include "ender_build.h"
 
+/* Atomic helpers to publish data that is read without locks. Once published
+ * with ENDER_ATOMIC_SET or ENDER_ATOMIC_CAS, the data is never modified, and
+ * any thread that reads the pointer with ENDER_ATOMIC_GET sees it complete
+ */
+#define ENDER_ATOMIC_GET(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define ENDER_ATOMIC_SET(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#define ENDER_ATOMIC_CAS(p, o, n) __sync_bool_compare_and_swap(p, o, n)
+#define ENDER_ATOMIC_ADD(p, v) __atomic_add_fetch(p, v, __ATOMIC_ACQ_REL)
+/* Order a write before a later read of another location */
+#define ENDER_ATOMIC_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
 #endif
@@ -109,6 +109,61 @@ ssize_t ender_value_type_alignment_get(Ender_Value_Type t)
 		return 0;
 	}
 }
+
+ffi_type * ender_value_type_ffi_to(Ender_Value_Type vt)
+{
+	switch (vt)
+	{
+		case ENDER_VALUE_TYPE_BOOL:
+		return &ffi_type_uint8;
+		break;
+
+		case ENDER_VALUE_TYPE_UINT8:
+		return &ffi_type_uint8;
+		break;
+
+		case ENDER_VALUE_TYPE_INT8:
+		return &ffi_type_sint8;
+		break;
+
+		case ENDER_VALUE_TYPE_UINT32:
+		return &ffi_type_uint32;
+		break;
+
+		case ENDER_VALUE_TYPE_INT32:
+		return &ffi_type_sint32;
+		break;
+
+		case ENDER_VALUE_TYPE_UINT64:
+		return &ffi_type_uint64;
+		break;
+
+		case ENDER_VALUE_TYPE_INT64:
+		return &ffi_type_sint64;
+		break;
+
+		case ENDER_VALUE_TYPE_DOUBLE:
+		return &ffi_type_double;
+		break;
+
+		case ENDER_VALUE_TYPE_SIZE:
+		if (sizeof(size_t) == sizeof(uint64_t))
+			return &ffi_type_uint64;
+		else
+			return &ffi_type_uint32;
+		break;
+
+		case ENDER_VALUE_TYPE_STRING:
+		case ENDER_VALUE_TYPE_POINTER:
+		return &ffi_type_pointer;
+		break;
+
+		default:
+		ERR("Unsupported value type '%d'", vt);
+		return &ffi_type_pointer;
+		break;
+	}
+}
 /*============================================================================*
  *                                   API                                      *
  *============================================================================*/
@@ -70,6 +70,8 @@ typedef enum _Ender_Value_Type
 	ENDER_VALUE_TYPE_SIZE,
 } Ender_Value_Type;
 
+#define ENDER_VALUE_TYPES (ENDER_VALUE_TYPE_SIZE + 1)
+
 /**
  * @}
  */
@@ -21,5 +21,6 @@
 
 size_t ender_value_type_size_get(Ender_Value_Type t);
 ssize_t ender_value_type_alignment_get(Ender_Value_Type t);
+ffi_type * ender_value_type_ffi_to(Ender_Value_Type t);
 
 #endif
@@ -9,6 +9,63 @@ src_tests_ender_test_utils_SOURCES = src/tests/ender_test_utils.c
 src_tests_ender_test_utils_CPPFLAGS = -I$(top_srcdir)/src/lib @ENDER_CFLAGS@ @CHECK_CFLAGS@
 src_tests_ender_test_utils_LDADD = $(top_builddir)/src/lib/libender.la @ENDER_LIBS@ @CHECK_LIBS@
 
+check_PROGRAMS += src/tests/ender_bench
+
+src_tests_ender_bench_SOURCES = src/tests/ender_bench.c
+src_tests_ender_bench_CPPFLAGS = -I$(top_srcdir)/src/lib @ENDER_CFLAGS@
+src_tests_ender_bench_LDADD = $(top_builddir)/src/lib/libender.la @ENDER_LIBS@
+# the described functions are looked up on the benchmark binary itself
+src_tests_ender_bench_LDFLAGS = -export-dynamic
+
+TESTS += src/tests/ender_stress
+
+check_PROGRAMS += src/tests/ender_stress
+
+src_tests_ender_stress_SOURCES = src/tests/ender_stress.c
+src_tests_ender_stress_CPPFLAGS = -I$(top_srcdir)/src/lib @ENDER_CFLAGS@
+src_tests_ender_stress_LDADD = $(top_builddir)/src/lib/libender.la @ENDER_LIBS@
+
+TESTS += src/tests/ender_call
+
+check_PROGRAMS += src/tests/ender_call
+
+src_tests_ender_call_SOURCES = src/tests/ender_call.c
+src_tests_ender_call_CPPFLAGS = -I$(top_srcdir)/src/lib @ENDER_CFLAGS@
+src_tests_ender_call_LDADD = $(top_builddir)/src/lib/libender.la @ENDER_LIBS@
+# the described functions are looked up on the test binary itself
+src_tests_ender_call_LDFLAGS = -export-dynamic
+
+TESTS += src/tests/ender_cache
+
+check_PROGRAMS += src/tests/ender_cache
+
+src_tests_ender_cache_SOURCES = src/tests/ender_cache.c
+src_tests_ender_cache_CPPFLAGS = -I$(top_srcdir)/src/lib @ENDER_CFLAGS@
+src_tests_ender_cache_LDADD = $(top_builddir)/src/lib/libender.la @ENDER_LIBS@
+
+TESTS += src/tests/ender_image
+
+check_PROGRAMS += src/tests/ender_image
+
+src_tests_ender_image_SOURCES = src/tests/ender_image.c
+# the image of the lib described on ender_image.ender
+nodist_src_tests_ender_image_SOURCES = src/tests/ender_image_lib.c
+src_tests_ender_image_CPPFLAGS = -I$(top_srcdir)/src/lib @ENDER_CFLAGS@
+src_tests_ender_image_LDADD = $(top_builddir)/src/lib/libender.la @ENDER_LIBS@
+
+src/tests/ender_image_lib.c: $(top_srcdir)/src/tests/ender_image.ender src/bin/ender-compile$(EXEEXT)
+	$(AM_V_GEN)$(top_builddir)/src/bin/ender-compile $(top_srcdir)/src/tests/ender_image.ender $@
+
+CLEANFILES += src/tests/ender_image_lib.c
+
+TESTS += src/tests/ender_parser
+
+check_PROGRAMS += src/tests/ender_parser
+
+src_tests_ender_parser_SOURCES = src/tests/ender_parser.c
+src_tests_ender_parser_CPPFLAGS = -I$(top_srcdir)/src/lib @ENDER_CFLAGS@
+src_tests_ender_parser_LDADD = $(top_builddir)/src/lib/libender.la @ENDER_LIBS@
+
 src_tests_test01_SOURCES = \
 src/tests/test01.c \
 src/tests/test_dummy.c \
@@ -36,3 +93,5 @@ $(top_builddir)/src/lib/libender.la \
 @ENDER_LIBS@
 
 endif
+
+EXTRA_DIST += src/tests/ender_image.ender
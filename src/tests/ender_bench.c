@@ -0,0 +1,417 @@
+#include "Ender.h"
+
+#include <time.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* The functions described on the benchmark lib below. They are exported by
+ * the benchmark binary itself, when the lib fails to be dlopen()ed the
+ * symbols are looked up on the global namespace
+ */
+typedef struct _Bench_Object
+{
+	int32_t i32;
+	double d;
+} Bench_Object;
+
+Bench_Object * bench_object_new(void)
+{
+	return calloc(1, sizeof(Bench_Object));
+}
+
+void bench_object_i32_set(Bench_Object *thiz, int32_t i32)
+{
+	thiz->i32 = i32;
+}
+
+int32_t bench_object_i32_get(Bench_Object *thiz)
+{
+	return thiz->i32;
+}
+
+double bench_object_mix(Bench_Object *thiz, int32_t a, double b,
+		int32_t c, double d)
+{
+	return thiz->i32 + a + b + c + d;
+}
+
+static const char *_description =
+"<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+"<lib name=\"bench\" version=\"0\" case=\"underscore\">\n"
+"  <object name=\"bench.object\">\n"
+"    <ctor name=\"new\"/>\n"
+"    <prop name=\"i32\">\n"
+"      <setter><arg name=\"i32\" type=\"int32\"/></setter>\n"
+"      <getter><return type=\"int32\"/></getter>\n"
+"    </prop>\n"
+"    <method name=\"mix\">\n"
+"      <arg name=\"a\" type=\"int32\"/>\n"
+"      <arg name=\"b\" type=\"double\"/>\n"
+"      <arg name=\"c\" type=\"int32\"/>\n"
+"      <arg name=\"d\" type=\"double\"/>\n"
+"      <return type=\"double\"/>\n"
+"    </method>\n"
+"  </object>\n"
+"</lib>\n";
+/*----------------------------------------------------------------------------*
+ *                             allocation count                               *
+ *----------------------------------------------------------------------------*/
+/* Count the allocations done while _allocs_count is set, this way we can
+ * catch regressions on paths that should not allocate at all
+ */
+static Eina_Bool _allocs_count = EINA_FALSE;
+static int _allocs = 0;
+
+#ifdef __GLIBC__
+extern void * __libc_malloc(size_t size);
+extern void * __libc_calloc(size_t nmemb, size_t size);
+extern void * __libc_realloc(void *ptr, size_t size);
+
+void * malloc(size_t size)
+{
+	if (_allocs_count) _allocs++;
+	return __libc_malloc(size);
+}
+
+void * calloc(size_t nmemb, size_t size)
+{
+	if (_allocs_count) _allocs++;
+	return __libc_calloc(nmemb, size);
+}
+
+void * realloc(void *ptr, size_t size)
+{
+	if (_allocs_count) _allocs++;
+	return __libc_realloc(ptr, size);
+}
+#endif
+/*----------------------------------------------------------------------------*
+ *                                 helpers                                    *
+ *----------------------------------------------------------------------------*/
+static double _time_get(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + (t.tv_nsec / 1e9);
+}
+
+static void _result_print(const char *name, int iterations, double elapsed)
+{
+	printf("%-24s %10d calls %10.3f ms %8.1f ns/call\n", name, iterations,
+			elapsed * 1e3, (elapsed * 1e9) / iterations);
+}
+
+static Ender_Item * _item_find(Eina_List *items, const char *name)
+{
+	Ender_Item *i;
+	Ender_Item *ret = NULL;
+
+	EINA_LIST_FREE(items, i)
+	{
+		if (!ret && !strcmp(ender_item_name_get(i), name))
+			ret = i;
+		else
+			ender_item_unref(i);
+	}
+	return ret;
+}
+/*----------------------------------------------------------------------------*
+ *                                benchmarks                                  *
+ *----------------------------------------------------------------------------*/
+static void _bench_prop_get(Ender_Item *prop, void *o, int iterations)
+{
+	Ender_Value v;
+	double start;
+	int i;
+
+	start = _time_get();
+	for (i = 0; i < iterations; i++)
+		ender_item_attr_value_get(prop, o, NULL, &v, NULL);
+	_result_print("prop get", iterations, _time_get() - start);
+}
+
+static void _bench_prop_set(Ender_Item *prop, void *o, int iterations)
+{
+	Ender_Value v;
+	double start;
+	int i;
+
+	start = _time_get();
+	for (i = 0; i < iterations; i++)
+	{
+		v.i32 = i;
+		ender_item_attr_value_set(prop, o, &v, NULL);
+	}
+	_result_print("prop set", iterations, _time_get() - start);
+}
+
+static void _bench_method_call(Ender_Item *method, void *o, int iterations)
+{
+	Ender_Value args[5];
+	Ender_Value ret;
+	double start;
+	int i;
+
+	args[0].ptr = o;
+	args[1].i32 = 1;
+	args[2].d = 2.0;
+	args[3].i32 = 3;
+	args[4].d = 4.0;
+
+	start = _time_get();
+	for (i = 0; i < iterations; i++)
+		ender_item_function_call(method, args, &ret);
+	_result_print("method call (4 args)", iterations, _time_get() - start);
+}
+
+static void _bench_call_invoke(Ender_Item *method, void *o, int iterations)
+{
+	Ender_Call *call;
+	Ender_Value args[5];
+	Ender_Value ret;
+	double start;
+	int i;
+
+	call = ender_item_function_call_prepare(method);
+	if (!call) return;
+
+	args[0].ptr = o;
+	args[1].i32 = 1;
+	args[2].d = 2.0;
+	args[3].i32 = 3;
+	args[4].d = 4.0;
+
+	start = _time_get();
+	for (i = 0; i < iterations; i++)
+		ender_call_invoke(call, args, &ret);
+	_result_print("call invoke (4 args)", iterations, _time_get() - start);
+	ender_call_free(call);
+}
+
+static void _bench_call_batch(Ender_Item *method, void *o, int iterations)
+{
+	Ender_Value *args;
+	Ender_Value *rets;
+	double start;
+	int i;
+
+	args = calloc(iterations * 5, sizeof(Ender_Value));
+	rets = calloc(iterations, sizeof(Ender_Value));
+	for (i = 0; i < iterations; i++)
+	{
+		args[(i * 5) + 0].ptr = o;
+		args[(i * 5) + 1].i32 = i;
+		args[(i * 5) + 2].d = 2.0;
+		args[(i * 5) + 3].i32 = 3;
+		args[(i * 5) + 4].d = 4.0;
+	}
+
+	start = _time_get();
+	ender_item_function_call_batch(method, args, 5, iterations, rets);
+	_result_print("call batch (4 args)", iterations, _time_get() - start);
+	free(rets);
+	free(args);
+}
+
+/* The time from the initialization until the first lib is found, with the
+ * descriptions parsed on demand or all of them parsed on the init, and with
+ * or without the binary cache
+ */
+static void _bench_cold_start(const char *name, Eina_Bool eager,
+		Eina_Bool cache, int iterations)
+{
+	char label[64];
+	double start;
+	int i;
+
+	setenv("ENDER_EAGER_LOAD", eager ? "1" : "0", 1);
+	setenv("ENDER_CACHE", cache ? "1" : "0", 1);
+	/* the first run writes the cache */
+	if (cache)
+	{
+		ender_init();
+		ender_lib_find(name);
+		ender_shutdown();
+	}
+	start = _time_get();
+	for (i = 0; i < iterations; i++)
+	{
+		ender_init();
+		ender_lib_find(name);
+		ender_shutdown();
+	}
+	snprintf(label, sizeof(label), "cold start (%s%s)",
+			eager ? "eager" : "lazy", cache ? "+cache" : "");
+	_result_print(label, iterations, _time_get() - start);
+	unsetenv("ENDER_CACHE");
+	unsetenv("ENDER_EAGER_LOAD");
+}
+
+/* The parser throughput on a generated description with a lot of items */
+static void _bench_parse(int items, int iterations)
+{
+	double elapsed = 0;
+	long size;
+	FILE *f;
+	int i;
+
+	_allocs = 0;
+	f = tmpfile();
+	if (!f) return;
+	fprintf(f, "<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+			"<lib name=\"parse\" version=\"0\" case=\"underscore\">\n");
+	for (i = 0; i < items; i++)
+	{
+		fprintf(f, "  <struct name=\"parse.point%d\">\n"
+				"    <field name=\"x\" type=\"int32\"/>\n"
+				"    <field name=\"y\" type=\"double\"/>\n"
+				"  </struct>\n", i);
+		fprintf(f, "  <object name=\"parse.object%d\">\n"
+				"    <ctor name=\"new\"/>\n"
+				"    <prop name=\"i32\">\n"
+				"      <setter><arg name=\"i32\" type=\"int32\"/></setter>\n"
+				"      <getter><return type=\"int32\"/></getter>\n"
+				"    </prop>\n"
+				"    <method name=\"mix\">\n"
+				"      <arg name=\"p\" type=\"parse.point%d\" direction=\"in\" transfer=\"none\"/>\n"
+				"      <return type=\"double\"/>\n"
+				"    </method>\n"
+				"  </object>\n", i, i);
+	}
+	fprintf(f, "</lib>\n");
+	fflush(f);
+	size = ftell(f);
+
+	for (i = 0; i < iterations; i++)
+	{
+		double start;
+
+		rewind(f);
+		start = _time_get();
+		_allocs_count = EINA_TRUE;
+		ender_parser_parse(f);
+		_allocs_count = EINA_FALSE;
+		elapsed += _time_get() - start;
+		if (!ender_lib_unload("parse"))
+		{
+			printf("Failed to parse the generated description\n");
+			break;
+		}
+	}
+	fclose(f);
+	printf("%-24s %10ld bytes %10.3f ms %8.1f MB/s\n", "parse", size,
+			elapsed * 1e3 / iterations,
+			(double)size * iterations / elapsed / (1024 * 1024));
+#ifdef __GLIBC__
+	printf("%-24s %10d parses %10d allocs %8d allocs/parse\n", "parse",
+			iterations, _allocs, _allocs / iterations);
+#endif
+}
+
+static void _cache_dir_clean_cb(const char *name, const char *path,
+		void *data EINA_UNUSED)
+{
+	char file[PATH_MAX];
+
+	snprintf(file, sizeof(file), "%s/%s", path, name);
+	unlink(file);
+}
+
+static void _allocs_print(const char *name, int iterations)
+{
+	printf("%-24s %10d calls %10d allocs %6.2f allocs/call\n", name,
+			iterations, _allocs, (double)_allocs / iterations);
+}
+
+static void _bench_allocs(Ender_Item *ctor, Ender_Item *prop,
+		Ender_Item *method, void *o, int iterations)
+{
+	Ender_Value v;
+	int i;
+
+#ifndef __GLIBC__
+	printf("Allocation counting is not supported on this platform\n");
+	return;
+#endif
+	_allocs = 0;
+	_allocs_count = EINA_TRUE;
+	for (i = 0; i < iterations; i++)
+		ender_item_attr_value_get(prop, o, NULL, &v, NULL);
+	_allocs_count = EINA_FALSE;
+	_allocs_print("prop get", iterations);
+
+	_allocs = 0;
+	_allocs_count = EINA_TRUE;
+	for (i = 0; i < iterations; i++)
+		ender_item_unref(ender_item_function_args_at(method, 0));
+	_allocs_count = EINA_FALSE;
+	_allocs_print("method self arg", iterations);
+
+	_allocs = 0;
+	_allocs_count = EINA_TRUE;
+	for (i = 0; i < iterations; i++)
+		ender_item_unref(ender_item_function_ret_get(ctor));
+	_allocs_count = EINA_FALSE;
+	_allocs_print("ctor return arg", iterations);
+}
+
+int main(int argc, char **argv)
+{
+	const Ender_Lib *lib;
+	Ender_Item *object;
+	Ender_Item *ctor;
+	Ender_Item *prop;
+	Ender_Item *method;
+	Ender_Value ret;
+	char cache_dir[] = "/tmp/ender-bench-XXXXXX";
+	int iterations = 1000000;
+
+	if (argc > 1)
+		iterations = atoi(argv[1]);
+
+	/* before any other initialization, on a private cache dir */
+	if (!mkdtemp(cache_dir)) return 1;
+	setenv("ENDER_CACHE_DIR", cache_dir, 1);
+	_bench_cold_start("eina", EINA_FALSE, EINA_FALSE, 100);
+	_bench_cold_start("eina", EINA_TRUE, EINA_FALSE, 100);
+	_bench_cold_start("eina", EINA_FALSE, EINA_TRUE, 100);
+	_bench_cold_start("eina", EINA_TRUE, EINA_TRUE, 100);
+	eina_file_dir_list(cache_dir, EINA_FALSE, _cache_dir_clean_cb, NULL);
+	rmdir(cache_dir);
+	unsetenv("ENDER_CACHE_DIR");
+
+	ender_init();
+	_bench_parse(1000, 20);
+	ender_parser_parse_buffer(_description, strlen(_description));
+
+	lib = ender_lib_find("bench");
+	object = ender_lib_item_find(lib, "bench.object");
+	if (!object)
+	{
+		printf("Failed to parse the benchmark description\n");
+		goto shutdown;
+	}
+
+	ctor = _item_find(ender_item_object_ctor_get(object), "new");
+	prop = _item_find(ender_item_object_props_get(object), "i32");
+	method = _item_find(ender_item_object_functions_get(object), "mix");
+
+	ender_item_function_call(ctor, NULL, &ret);
+	_bench_prop_set(prop, ret.ptr, iterations);
+	_bench_prop_get(prop, ret.ptr, iterations);
+	_bench_method_call(method, ret.ptr, iterations);
+	_bench_call_invoke(method, ret.ptr, iterations);
+	_bench_call_batch(method, ret.ptr, iterations);
+	_bench_allocs(ctor, prop, method, ret.ptr, iterations);
+	free(ret.ptr);
+
+	ender_item_unref(method);
+	ender_item_unref(prop);
+	ender_item_unref(ctor);
+	ender_item_unref(object);
+shutdown:
+	ender_shutdown();
+	return 0;
+}
@@ -0,0 +1,439 @@
+#include "Ender.h"
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/* The described libraries are stored on the cache once parsed and loaded from
+ * it while their descriptions and the ones they include do not change. The
+ * loaded libs must be the same as the parsed ones, and the images that do not
+ * match the libs they include are rejected
+ */
+static const char *_base_description =
+"<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+"<lib name=\"base\" version=\"0\" case=\"underscore\">\n"
+"  <def name=\"base.coord\" type=\"%s\"/>\n"
+"</lib>\n";
+
+/* the offset of b depends on the def of the included lib */
+static const char *_shape_description =
+"<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+"<lib name=\"shape\" version=\"0\" case=\"underscore\">\n"
+"  <include name=\"base\"/>\n"
+"  <struct name=\"shape.point\">\n"
+"    <field name=\"a\" type=\"base.coord\"/>\n"
+"    <field name=\"b\" type=\"int32\"/>\n"
+"  </struct>\n"
+"</lib>\n";
+
+/* every kind of item, to compare the parsed lib with the cached one */
+static const char *_round_description =
+"<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+"<lib name=\"round\" version=\"2\" case=\"underscore\">\n"
+"  <include name=\"base\"/>\n"
+"  <def name=\"round.size\" type=\"base.coord\"/>\n"
+"  <enum name=\"round.mode\">\n"
+"    <value name=\"fast\" value=\"0\"/>\n"
+"    <value name=\"slow\" value=\"1\"/>\n"
+"  </enum>\n"
+"  <struct name=\"round.box\">\n"
+"    <field name=\"w\" type=\"round.size\"/>\n"
+"    <field name=\"h\" type=\"double\"/>\n"
+"    <field name=\"n\" type=\"int32\"/>\n"
+"  </struct>\n"
+"  <object name=\"round.shape\">\n"
+"    <ctor name=\"new\"/>\n"
+"    <prop name=\"mode\">\n"
+"      <setter><arg name=\"mode\" type=\"round.mode\"/></setter>\n"
+"      <getter><return type=\"round.mode\"/></getter>\n"
+"    </prop>\n"
+"    <method name=\"area\">\n"
+"      <return type=\"double\"/>\n"
+"    </method>\n"
+"  </object>\n"
+"  <function name=\"round.box_area\">\n"
+"    <arg name=\"b\" type=\"round.box\"/>\n"
+"    <arg name=\"scale\" type=\"round.size\"/>\n"
+"    <return type=\"double\"/>\n"
+"  </function>\n"
+"</lib>\n";
+
+/* the last field only fits while the def is not bigger than an int32 */
+static const char *_tail_description =
+"<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+"<lib name=\"tail\" version=\"0\" case=\"underscore\">\n"
+"  <include name=\"base\"/>\n"
+"  <struct name=\"tail.point\">\n"
+"    <field name=\"a\" type=\"int32\"/>\n"
+"    <field name=\"b\" type=\"base.coord\"/>\n"
+"  </struct>\n"
+"</lib>\n";
+
+static char _dir[] = "/tmp/ender-cache-XXXXXX";
+
+static void _file_write(const char *name, const char *description,
+		const char *type)
+{
+	char path[PATH_MAX];
+	FILE *f;
+
+	snprintf(path, sizeof(path), "%s/%s", _dir, name);
+	f = fopen(path, "w");
+	fprintf(f, description, type);
+	fclose(f);
+}
+
+static void _file_remove(const char *name)
+{
+	char path[PATH_MAX];
+
+	snprintf(path, sizeof(path), "%s/%s", _dir, name);
+	unlink(path);
+}
+
+static ino_t _cache_inode(const char *name)
+{
+	char path[PATH_MAX];
+	struct stat st;
+
+	snprintf(path, sizeof(path), "%s/cache/%s.enderc", _dir, name);
+	if (stat(path, &st) < 0)
+		return 0;
+	return st.st_ino;
+}
+
+/* The offset of the second field of the struct */
+static ssize_t _offset_get(void)
+{
+	const Ender_Lib *lib;
+	Ender_Item *point;
+	Ender_Item *field;
+	Eina_List *fields;
+	ssize_t ret = -1;
+
+	ender_init();
+	lib = ender_lib_find("shape");
+	point = ender_lib_item_find(lib, "shape.point");
+	if (point)
+	{
+		fields = ender_item_struct_fields_get(point);
+		field = eina_list_nth(fields, 1);
+		if (field)
+			ret = ender_item_attr_offset_get(field);
+		EINA_LIST_FREE(fields, field)
+			ender_item_unref(field);
+		ender_item_unref(point);
+	}
+	ender_shutdown();
+	return ret;
+}
+
+/* A changed def of an included lib outdates the cache */
+static int _deps(void)
+{
+	ino_t inode;
+	int errors = 0;
+
+	_file_write("base.ender", _base_description, "int32");
+	_file_write("shape.ender", _shape_description, NULL);
+	if (_offset_get() != 4)
+		errors++;
+	inode = _cache_inode("shape");
+	if (!inode)
+		errors++;
+	/* loaded from the cache */
+	if (_offset_get() != 4)
+		errors++;
+	if (_cache_inode("shape") != inode)
+		errors++;
+
+	_file_write("base.ender", _base_description, "double");
+	if (_offset_get() != 8)
+		errors++;
+	if (_cache_inode("shape") == inode)
+		errors++;
+
+	if (errors)
+		printf("Included libs failed with %d errors\n", errors);
+	return errors;
+}
+
+static const char * _item_type_name_get(Ender_Item *i)
+{
+	const char *name;
+
+	if (!i)
+		return "none";
+	name = ender_item_name_get(i);
+	return name ? name : "";
+}
+
+static void _line_add(Eina_List **lines, const char *fmt, ...)
+{
+	va_list args;
+	char line[PATH_MAX];
+
+	va_start(args, fmt);
+	vsnprintf(line, sizeof(line), fmt, args);
+	va_end(args);
+	*lines = eina_list_append(*lines, strdup(line));
+}
+
+/* The names of a list of items, the list is freed */
+static void _items_add(Eina_List **lines, const char *parent,
+		const char *kind, Eina_List *items)
+{
+	Ender_Item *i;
+
+	EINA_LIST_FREE(items, i)
+	{
+		_line_add(lines, "%s %s %s", parent, kind, ender_item_name_get(i));
+		ender_item_unref(i);
+	}
+}
+
+static void _item_add(Eina_List **lines, Ender_Item *i)
+{
+	const char *name = ender_item_name_get(i);
+	Ender_Item *type;
+	Ender_Item *child;
+	Eina_List *children;
+
+	_line_add(lines, "%s %s", ender_item_type_name_get(
+			ender_item_type_get(i)), name);
+	switch (ender_item_type_get(i))
+	{
+		case ENDER_ITEM_TYPE_STRUCT:
+		_line_add(lines, "%s size %zu", name, ender_item_struct_size_get(i));
+		children = ender_item_struct_fields_get(i);
+		EINA_LIST_FREE(children, child)
+		{
+			type = ender_item_attr_type_get(child);
+			_line_add(lines, "%s field %s %zd %s", name,
+					ender_item_name_get(child),
+					ender_item_attr_offset_get(child),
+					_item_type_name_get(type));
+			ender_item_unref(type);
+			ender_item_unref(child);
+		}
+		break;
+
+		case ENDER_ITEM_TYPE_OBJECT:
+		_items_add(lines, name, "function",
+				ender_item_object_functions_get(i));
+		_items_add(lines, name, "ctor", ender_item_object_ctor_get(i));
+		_items_add(lines, name, "prop", ender_item_object_props_get(i));
+		break;
+
+		case ENDER_ITEM_TYPE_FUNCTION:
+		children = ender_item_function_args_get(i);
+		EINA_LIST_FREE(children, child)
+		{
+			type = ender_item_arg_type_get(child);
+			_line_add(lines, "%s arg %s %s", name,
+					ender_item_name_get(child),
+					_item_type_name_get(type));
+			ender_item_unref(type);
+			ender_item_unref(child);
+		}
+		child = ender_item_function_ret_get(i);
+		if (child)
+		{
+			type = ender_item_arg_type_get(child);
+			_line_add(lines, "%s return %s", name,
+					_item_type_name_get(type));
+			ender_item_unref(type);
+			ender_item_unref(child);
+		}
+		break;
+
+		case ENDER_ITEM_TYPE_ENUM:
+		_items_add(lines, name, "value", ender_item_enum_values_get(i));
+		break;
+
+		case ENDER_ITEM_TYPE_DEF:
+		type = ender_item_def_type_get(i);
+		_line_add(lines, "%s type %s", name, _item_type_name_get(type));
+		ender_item_unref(type);
+		break;
+
+		default:
+		break;
+	}
+}
+
+static int _line_cmp(const void *l1, const void *l2)
+{
+	return strcmp(l1, l2);
+}
+
+/* A sorted description of every item of a lib, as seen through the API */
+static char * _lib_dump(const char *name)
+{
+	static const Ender_Item_Type types[] = {
+		ENDER_ITEM_TYPE_DEF,
+		ENDER_ITEM_TYPE_ENUM,
+		ENDER_ITEM_TYPE_STRUCT,
+		ENDER_ITEM_TYPE_OBJECT,
+		ENDER_ITEM_TYPE_FUNCTION,
+	};
+	const Ender_Lib *lib;
+	Eina_Strbuf *buf;
+	Eina_List *lines = NULL;
+	Eina_List *items;
+	Ender_Item *i;
+	char *line;
+	char *ret;
+	unsigned int t;
+
+	lib = ender_lib_find(name);
+	if (!lib)
+		return NULL;
+	_line_add(&lines, "version %d", ender_lib_version_get(lib));
+	_line_add(&lines, "case %d", ender_lib_case_get(lib));
+	items = ender_lib_dependencies_get(lib);
+	_line_add(&lines, "deps %d", eina_list_count(items));
+	eina_list_free(items);
+	for (t = 0; t < sizeof(types) / sizeof(types[0]); t++)
+	{
+		items = ender_lib_item_list(lib, types[t]);
+		EINA_LIST_FREE(items, i)
+		{
+			_item_add(&lines, i);
+			ender_item_unref(i);
+		}
+	}
+	items = ender_lib_symbols_get(lib);
+	EINA_LIST_FREE(items, line)
+	{
+		_line_add(&lines, "symbol %s", line);
+		free(line);
+	}
+
+	lines = eina_list_sort(lines, -1, _line_cmp);
+	buf = eina_strbuf_new();
+	EINA_LIST_FREE(lines, line)
+	{
+		eina_strbuf_append(buf, line);
+		eina_strbuf_append_char(buf, '\n');
+		free(line);
+	}
+	ret = eina_strbuf_string_steal(buf);
+	eina_strbuf_free(buf);
+	return ret;
+}
+
+/* The lib loaded from the cache is the same as the parsed one */
+static int _round_trip(void)
+{
+	char *parsed;
+	char *cached;
+	ino_t inode;
+	int errors = 0;
+
+	_file_write("base.ender", _base_description, "int32");
+	_file_write("round.ender", _round_description, NULL);
+	ender_init();
+	parsed = _lib_dump("round");
+	ender_shutdown();
+	inode = _cache_inode("round");
+	if (!parsed || !inode)
+	{
+		printf("Round trip failed to parse or save the lib\n");
+		free(parsed);
+		return 1;
+	}
+
+	ender_init();
+	cached = _lib_dump("round");
+	ender_shutdown();
+	if (_cache_inode("round") != inode)
+		errors++;
+	if (!cached || strcmp(parsed, cached))
+	{
+		printf("Parsed:\n%s\nCached:\n%s\n", parsed, cached);
+		errors++;
+	}
+	free(parsed);
+	free(cached);
+	_file_remove("round.ender");
+
+	if (errors)
+		printf("Round trip failed with %d errors\n", errors);
+	return errors;
+}
+
+/* An image whose fields do not fit anymore on their struct is rejected */
+static int _layout(void)
+{
+	Ender_Lib_Image image;
+	const Ender_Lib *lib;
+	void *data;
+	size_t size;
+	int errors = 0;
+
+	_file_write("base.ender", _base_description, "int32");
+	_file_write("tail.ender", _tail_description, NULL);
+	ender_init();
+	data = ender_lib_image_new(ender_lib_find("tail"), &size);
+	ender_shutdown();
+	_file_remove("tail.ender");
+	if (!data)
+	{
+		printf("Layout failed to create the image\n");
+		return 1;
+	}
+	image.data = data;
+	image.size = size;
+	image.symbols = NULL;
+	image.nsymbols = 0;
+
+	/* the same layout */
+	ender_init();
+	ender_lib_image_add(&image);
+	lib = ender_lib_find("tail");
+	if (!lib || !ender_lib_item_find(lib, "tail.point"))
+		errors++;
+	ender_shutdown();
+
+	/* the def grows, the last field is out of the struct */
+	_file_write("base.ender", _base_description, "double");
+	ender_init();
+	ender_lib_image_add(&image);
+	if (ender_lib_find("tail"))
+		errors++;
+	ender_shutdown();
+	free(data);
+
+	if (errors)
+		printf("Layout failed with %d errors\n", errors);
+	return errors;
+}
+
+int main(int argc EINA_UNUSED, char **argv EINA_UNUSED)
+{
+	char cache[PATH_MAX];
+	char cmd[PATH_MAX];
+	int errors = 0;
+
+	if (!mkdtemp(_dir))
+	{
+		printf("Impossible to create the descriptions dir\n");
+		return 1;
+	}
+	snprintf(cache, sizeof(cache), "%s/cache", _dir);
+	setenv("ENDER_DESCRIPTIONS_DIR", _dir, 1);
+	setenv("ENDER_CACHE_DIR", cache, 1);
+
+	errors += _deps();
+	errors += _round_trip();
+	errors += _layout();
+
+	snprintf(cmd, sizeof(cmd), "rm -rf %s", _dir);
+	if (system(cmd))
+		errors++;
+	printf("Cache checked with %d errors\n", errors);
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,536 @@
+#include "Ender.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Every way of calling a function must give the same results: the direct
+ * calls, the prepared calls, the batches, the typed thunks, the generated
+ * code and libffi for the rest, the closures and the structs by value. The
+ * checks are done with the JIT disabled and then enabled
+ */
+#define ROWS 64
+#define CLOSURES 32
+
+/* The functions described on the lib below. They are exported by the test
+ * binary itself, the symbols are looked up on the global namespace
+ */
+typedef struct _Call_Object
+{
+	int32_t i32;
+	double d;
+} Call_Object;
+
+typedef struct _Call_Point
+{
+	int32_t x;
+	double y;
+} Call_Point;
+
+typedef int32_t (*Call_Cb)(int32_t a, void *data);
+
+static int _touched = 0;
+
+Call_Object * call_object_new(void)
+{
+	return calloc(1, sizeof(Call_Object));
+}
+
+void call_object_i32_set(Call_Object *thiz, int32_t i32)
+{
+	thiz->i32 = i32;
+}
+
+int32_t call_object_i32_get(Call_Object *thiz)
+{
+	return thiz->i32;
+}
+
+Eina_Bool call_object_clamp(Call_Object *thiz, int32_t max)
+{
+	if (thiz->i32 <= max)
+		return EINA_FALSE;
+	thiz->i32 = max;
+	return EINA_TRUE;
+}
+
+double call_object_mix(Call_Object *thiz, int32_t a, double b,
+		int32_t c, double d)
+{
+	return thiz->i32 + a + b + c + d;
+}
+
+void call_object_touch(Call_Object *thiz EINA_UNUSED)
+{
+	_touched++;
+}
+
+void call_reset(void)
+{
+	_touched = 0;
+}
+
+int64_t call_sum3(int64_t a, int64_t b, int64_t c)
+{
+	return a + b + c;
+}
+
+void call_divide(int32_t a, int32_t b, int32_t *quotient, int32_t *remainder)
+{
+	*quotient = a / b;
+	*remainder = a % b;
+}
+
+int32_t call_apply(Call_Cb cb, int32_t a, void *data)
+{
+	return cb(a, data);
+}
+
+Call_Point call_point_add(Call_Point a, Call_Point b)
+{
+	Call_Point ret;
+
+	ret.x = a.x + b.x;
+	ret.y = a.y + b.y;
+	return ret;
+}
+
+static const char *_description =
+"<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+"<lib name=\"call\" version=\"0\" case=\"underscore\">\n"
+"  <struct name=\"call.point\">\n"
+"    <field name=\"x\" type=\"int32\"/>\n"
+"    <field name=\"y\" type=\"double\"/>\n"
+"  </struct>\n"
+"  <callback name=\"call.cb\">\n"
+"    <arg name=\"a\" type=\"int32\"/>\n"
+"    <arg name=\"data\" type=\"pointer\"/>\n"
+"    <return type=\"int32\"/>\n"
+"  </callback>\n"
+"  <object name=\"call.object\">\n"
+"    <ctor name=\"new\"/>\n"
+"    <prop name=\"i32\">\n"
+"      <setter><arg name=\"i32\" type=\"int32\"/></setter>\n"
+"      <getter><return type=\"int32\"/></getter>\n"
+"    </prop>\n"
+"    <method name=\"clamp\">\n"
+"      <arg name=\"max\" type=\"int32\"/>\n"
+"      <return type=\"bool\"/>\n"
+"    </method>\n"
+"    <method name=\"mix\">\n"
+"      <arg name=\"a\" type=\"int32\"/>\n"
+"      <arg name=\"b\" type=\"double\"/>\n"
+"      <arg name=\"c\" type=\"int32\"/>\n"
+"      <arg name=\"d\" type=\"double\"/>\n"
+"      <return type=\"double\"/>\n"
+"    </method>\n"
+"    <method name=\"touch\"/>\n"
+"  </object>\n"
+"  <function name=\"call.reset\"/>\n"
+"  <function name=\"call.sum3\">\n"
+"    <arg name=\"a\" type=\"int64\"/>\n"
+"    <arg name=\"b\" type=\"int64\"/>\n"
+"    <arg name=\"c\" type=\"int64\"/>\n"
+"    <return type=\"int64\"/>\n"
+"  </function>\n"
+"  <function name=\"call.divide\">\n"
+"    <arg name=\"a\" type=\"int32\"/>\n"
+"    <arg name=\"b\" type=\"int32\"/>\n"
+"    <arg name=\"quotient\" type=\"pointer\"/>\n"
+"    <arg name=\"remainder\" type=\"pointer\"/>\n"
+"  </function>\n"
+"  <function name=\"call.apply\">\n"
+"    <arg name=\"cb\" type=\"call.cb\"/>\n"
+"    <arg name=\"a\" type=\"int32\"/>\n"
+"    <arg name=\"data\" type=\"pointer\"/>\n"
+"    <return type=\"int32\"/>\n"
+"  </function>\n"
+"  <function name=\"call.point_add\">\n"
+"    <arg name=\"a\" type=\"call.point\" by-value=\"true\"/>\n"
+"    <arg name=\"b\" type=\"call.point\" by-value=\"true\"/>\n"
+"    <return type=\"call.point\" by-value=\"true\"/>\n"
+"  </function>\n"
+"</lib>\n";
+
+static Ender_Item * _item_find(Eina_List *items, const char *name)
+{
+	Ender_Item *i;
+	Ender_Item *ret = NULL;
+
+	EINA_LIST_FREE(items, i)
+	{
+		if (!ret && !strcmp(ender_item_name_get(i), name))
+			ret = i;
+		else
+			ender_item_unref(i);
+	}
+	return ret;
+}
+
+static Ender_Item * _method_find(Ender_Item *object, const char *name)
+{
+	return _item_find(ender_item_object_functions_get(object), name);
+}
+
+/* The ctor, getters and setters go through the typed thunks */
+static int _thunks(Ender_Item *object, void *o)
+{
+	Ender_Item *prop;
+	Ender_Item *f;
+	Ender_Value args[2];
+	Ender_Value ret;
+	int errors = 0;
+
+	prop = _item_find(ender_item_object_props_get(object), "i32");
+	args[0].i32 = 21;
+	if (!ender_item_attr_value_set(prop, o, args, NULL))
+		errors++;
+	if (((Call_Object *)o)->i32 != 21)
+		errors++;
+	ret.i32 = 0;
+	if (!ender_item_attr_value_get(prop, o, NULL, &ret, NULL))
+		errors++;
+	if (ret.i32 != 21)
+		errors++;
+	ender_item_unref(prop);
+
+	/* Eina_Bool f(ptr, TYPE) */
+	f = _method_find(object, "clamp");
+	args[0].ptr = o;
+	args[1].i32 = 10;
+	ret.u64 = 0;
+	if (!ender_item_function_call(f, args, &ret) || !ret.b)
+		errors++;
+	if (((Call_Object *)o)->i32 != 10)
+		errors++;
+	args[1].i32 = 20;
+	if (!ender_item_function_call(f, args, &ret) || ret.b)
+		errors++;
+	ender_item_unref(f);
+
+	/* void f(ptr) and void f(void) */
+	f = _method_find(object, "touch");
+	args[0].ptr = o;
+	if (!ender_item_function_call(f, args, NULL) || _touched != 1)
+		errors++;
+	ender_item_unref(f);
+	f = ender_lib_item_find(ender_lib_find("call"), "call.reset");
+	if (!ender_item_function_call(f, NULL, NULL) || _touched != 0)
+		errors++;
+	ender_item_unref(f);
+
+	if (errors)
+		printf("Typed thunks failed with %d errors\n", errors);
+	return errors;
+}
+
+/* The prototypes without a thunk go through the generated code or libffi */
+static int _calls(const Ender_Lib *lib, Ender_Item *object, void *o)
+{
+	Ender_Item *f;
+	Ender_Call *call;
+	Ender_Item *i;
+	Ender_Value args[5];
+	Ender_Value ret;
+	int32_t quotient = 0;
+	int32_t remainder = 0;
+	int errors = 0;
+
+	((Call_Object *)o)->i32 = 1;
+	f = _method_find(object, "mix");
+	args[0].ptr = o;
+	args[1].i32 = 2;
+	args[2].d = 0.5;
+	args[3].i32 = 3;
+	args[4].d = 0.25;
+	ret.d = 0;
+	if (!ender_item_function_call(f, args, &ret) || ret.d != 6.75)
+		errors++;
+
+	/* the prepared call gives the same result */
+	call = ender_item_function_call_prepare(f);
+	if (!call)
+	{
+		errors++;
+	}
+	else
+	{
+		if (ender_call_args_count(call) != 5)
+			errors++;
+		i = ender_call_item_get(call);
+		if (i != f)
+			errors++;
+		ender_item_unref(i);
+		ret.d = 0;
+		ender_call_invoke(call, args, &ret);
+		if (ret.d != 6.75)
+			errors++;
+		ender_call_free(call);
+	}
+	ender_item_unref(f);
+
+	f = ender_lib_item_find(lib, "call.sum3");
+	args[0].i64 = INT64_C(1) << 40;
+	args[1].i64 = -2;
+	args[2].i64 = 3;
+	ret.i64 = 0;
+	if (!ender_item_function_call(f, args, &ret) ||
+			ret.i64 != (INT64_C(1) << 40) + 1)
+		errors++;
+	ender_item_unref(f);
+
+	/* the out args are written through the pointers */
+	f = ender_lib_item_find(lib, "call.divide");
+	args[0].i32 = 17;
+	args[1].i32 = 5;
+	args[2].ptr = &quotient;
+	args[3].ptr = &remainder;
+	if (!ender_item_function_call(f, args, NULL))
+		errors++;
+	if (quotient != 3 || remainder != 2)
+		errors++;
+	ender_item_unref(f);
+
+	if (errors)
+		printf("Calls failed with %d errors\n", errors);
+	return errors;
+}
+
+/* Every row of a batch gives the same result as a single call */
+static int _batch(Ender_Item *object, void *o)
+{
+	Ender_Item *f;
+	Ender_Value args[ROWS * 5];
+	Ender_Value rets[ROWS];
+	int errors = 0;
+	int i;
+
+	((Call_Object *)o)->i32 = 1;
+	f = _method_find(object, "mix");
+	for (i = 0; i < ROWS; i++)
+	{
+		args[(i * 5) + 0].ptr = o;
+		args[(i * 5) + 1].i32 = i;
+		args[(i * 5) + 2].d = 0.5;
+		args[(i * 5) + 3].i32 = -i;
+		args[(i * 5) + 4].d = i;
+		rets[i].d = -1;
+	}
+	if (!ender_item_function_call_batch(f, args, 5, ROWS, rets))
+		errors++;
+	for (i = 0; i < ROWS; i++)
+	{
+		if (rets[i].d != 1.5 + i)
+			errors++;
+	}
+	ender_item_unref(f);
+
+	if (errors)
+		printf("Batch failed with %d errors\n", errors);
+	return errors;
+}
+
+static void _closure_cb(Ender_Item *i EINA_UNUSED, Ender_Value *args,
+		Ender_Value *retval, void *data)
+{
+	retval->i32 = (args[0].i32 * 2) + *(int32_t *)data +
+			*(int32_t *)args[1].ptr;
+}
+
+/* The C side calls back through the closures, pooled or not */
+static int _closures(const Ender_Lib *lib)
+{
+	Ender_Closure *closures[CLOSURES];
+	Ender_Item *cb;
+	Ender_Item *f;
+	Ender_Value args[3];
+	Ender_Value ret;
+	int32_t offsets[CLOSURES];
+	int32_t extra = 1000;
+	int live;
+	int pooled;
+	int errors = 0;
+	int n;
+	int i;
+
+	cb = ender_lib_item_find(lib, "call.cb");
+	f = ender_lib_item_find(lib, "call.apply");
+	/* the second round reuses the pooled closures */
+	for (n = 0; n < 2; n++)
+	{
+		for (i = 0; i < CLOSURES; i++)
+		{
+			offsets[i] = i * 100;
+			closures[i] = ender_item_function_closure_new(cb, _closure_cb,
+					&offsets[i]);
+			if (!closures[i])
+				errors++;
+		}
+		for (i = 0; i < CLOSURES; i++)
+		{
+			if (!closures[i])
+				continue;
+			args[0].ptr = ender_closure_code_get(closures[i]);
+			args[1].i32 = i;
+			args[2].ptr = &extra;
+			ret.i32 = 0;
+			if (!ender_item_function_call(f, args, &ret) ||
+					ret.i32 != (i * 2) + (i * 100) + 1000)
+				errors++;
+		}
+		for (i = 0; i < CLOSURES; i++)
+			ender_closure_free(closures[i]);
+	}
+	ender_closure_counters_get(&live, &pooled);
+	if (live || !pooled)
+		errors++;
+	ender_item_unref(f);
+	ender_item_unref(cb);
+
+	if (errors)
+		printf("Closures failed with %d errors\n", errors);
+	return errors;
+}
+
+/* The structs are passed and returned by value */
+static int _structs(const Ender_Lib *lib)
+{
+	Ender_Item *point;
+	Ender_Item *f;
+	Ender_Value args[2];
+	Ender_Value ret;
+	Call_Point *a;
+	Call_Point *b;
+	Call_Point *r;
+	int errors = 0;
+
+	point = ender_lib_item_find(lib, "call.point");
+	f = ender_lib_item_find(lib, "call.point_add");
+	if (ender_item_struct_size_get(point) != sizeof(Call_Point))
+		errors++;
+	a = ender_item_struct_instance_new(point);
+	b = ender_item_struct_instance_new(point);
+	r = ender_item_struct_instance_new(point);
+	a->x = 1;
+	a->y = 0.5;
+	b->x = 2;
+	b->y = 0.25;
+	args[0].ptr = a;
+	args[1].ptr = b;
+	ret.ptr = r;
+	if (!ender_item_function_call(f, args, &ret))
+		errors++;
+	if (r->x != 3 || r->y != 0.75)
+		errors++;
+	/* the arguments are not modified */
+	if (a->x != 1 || b->x != 2)
+		errors++;
+	ender_item_struct_instance_free(point, r);
+	ender_item_struct_instance_free(point, b);
+	ender_item_struct_instance_free(point, a);
+	ender_item_unref(f);
+	ender_item_unref(point);
+
+	if (errors)
+		printf("Structs by value failed with %d errors\n", errors);
+	return errors;
+}
+
+/* The mappings of the generated code, each page is mapped twice */
+static int _jit_maps_count(void)
+{
+	FILE *f;
+	char line[512];
+	int count = 0;
+
+	f = fopen("/proc/self/maps", "r");
+	if (!f)
+		return -1;
+	while (fgets(line, sizeof(line), f))
+	{
+		if (strstr(line, "ender-jit"))
+			count++;
+	}
+	fclose(f);
+	return count;
+}
+
+/* The generated thunks share a page, unmapped once the lib is unloaded */
+static int _pages(Eina_Bool jit)
+{
+	const char *other =
+			"<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+			"<lib name=\"other\" version=\"0\" case=\"underscore\">\n"
+			"</lib>\n";
+	int count;
+	int errors = 0;
+
+	count = _jit_maps_count();
+	if (count < 0)
+		return 0;
+	if (count != (jit ? 2 : 0))
+		errors++;
+	if (!ender_lib_unload("call"))
+		errors++;
+	/* the page is retired, freed once a new lib is published */
+	ender_parser_parse_buffer(other, strlen(other));
+	if (_jit_maps_count() != 0)
+		errors++;
+
+	if (errors)
+		printf("JIT pages failed with %d errors\n", errors);
+	return errors;
+}
+
+static int _run(const char *jit)
+{
+	const Ender_Lib *lib;
+	Ender_Item *object;
+	Ender_Item *ctor;
+	Ender_Value ret;
+	int errors = 0;
+
+	setenv("ENDER_JIT", jit, 1);
+	ender_init();
+	ender_parser_parse_buffer(_description, strlen(_description));
+	lib = ender_lib_find("call");
+	object = ender_lib_item_find(lib, "call.object");
+	if (!object)
+	{
+		printf("Failed to parse the description\n");
+		ender_shutdown();
+		return 1;
+	}
+
+	/* TYPE f(void) */
+	ctor = _item_find(ender_item_object_ctor_get(object), "new");
+	ret.ptr = NULL;
+	if (!ender_item_function_call(ctor, NULL, &ret) || !ret.ptr)
+	{
+		printf("Failed to create the object\n");
+		errors++;
+		goto done;
+	}
+	errors += _thunks(object, ret.ptr);
+	errors += _calls(lib, object, ret.ptr);
+	errors += _batch(object, ret.ptr);
+	errors += _closures(lib);
+	errors += _structs(lib);
+	free(ret.ptr);
+done:
+	ender_item_unref(ctor);
+	ender_item_unref(object);
+	errors += _pages(!strcmp(jit, "1"));
+	ender_shutdown();
+	unsetenv("ENDER_JIT");
+
+	printf("Calls with ENDER_JIT=%s, %d errors\n", jit, errors);
+	return errors;
+}
+
+int main(int argc EINA_UNUSED, char **argv EINA_UNUSED)
+{
+	int errors = 0;
+
+	errors += _run("0");
+	errors += _run("1");
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,114 @@
+#include "Ender.h"
+#include <stddef.h>
+
+/* The lib described on ender_image.ender is compiled by ender-compile into
+ * ender_image_lib.c and linked on the test. The image must be loaded as if
+ * the description was parsed, with the symbols of the test binary
+ */
+typedef struct _Image_Point
+{
+	int32_t x;
+	double y;
+} Image_Point;
+
+Eina_Bool image_ender_register(void);
+
+int32_t image_add(int32_t a, int32_t b)
+{
+	return a + b;
+}
+
+void image_point_scale(Image_Point *p, double factor)
+{
+	p->x *= factor;
+	p->y *= factor;
+}
+
+/* The struct has the layout of the C one */
+static int _structs(const Ender_Lib *lib)
+{
+	Ender_Item *point;
+	Ender_Item *field;
+	Eina_List *fields;
+	int errors = 0;
+
+	point = ender_lib_item_find(lib, "image.point");
+	if (!point)
+		return 1;
+	if (ender_item_struct_size_get(point) != sizeof(Image_Point))
+		errors++;
+	fields = ender_item_struct_fields_get(point);
+	if (eina_list_count(fields) != 2)
+		errors++;
+	field = eina_list_nth(fields, 1);
+	if (!field || ender_item_attr_offset_get(field) != offsetof(Image_Point, y))
+		errors++;
+	EINA_LIST_FREE(fields, field)
+		ender_item_unref(field);
+	ender_item_unref(point);
+
+	if (errors)
+		printf("Structs failed with %d errors\n", errors);
+	return errors;
+}
+
+/* The symbols are taken from the image */
+static int _calls(const Ender_Lib *lib)
+{
+	Ender_Item *f;
+	Ender_Value args[2];
+	Ender_Value ret;
+	Image_Point p = { 2, 0.5 };
+	int errors = 0;
+
+	f = ender_lib_item_find(lib, "image.add");
+	args[0].i32 = 2;
+	args[1].i32 = 3;
+	ret.i32 = 0;
+	if (!ender_item_function_call(f, args, &ret) || ret.i32 != 5)
+		errors++;
+	ender_item_unref(f);
+
+	f = ender_lib_item_find(lib, "image.point_scale");
+	args[0].ptr = &p;
+	args[1].d = 2;
+	if (!ender_item_function_call(f, args, NULL))
+		errors++;
+	if (p.x != 4 || p.y != 1)
+		errors++;
+	ender_item_unref(f);
+
+	if (errors)
+		printf("Calls failed with %d errors\n", errors);
+	return errors;
+}
+
+int main(int argc EINA_UNUSED, char **argv EINA_UNUSED)
+{
+	const Ender_Lib *lib;
+	int errors = 0;
+
+	ender_init();
+	if (!image_ender_register())
+	{
+		printf("Impossible to add the image\n");
+		ender_shutdown();
+		return 1;
+	}
+	/* named as the description, not as the file */
+	lib = ender_lib_find("image");
+	if (!lib)
+	{
+		printf("Image not found\n");
+		ender_shutdown();
+		return 1;
+	}
+	if (ender_lib_find("ender_image"))
+		errors++;
+	errors += _structs(lib);
+	errors += _calls(lib);
+	ender_shutdown();
+
+	printf("Image checked with %d errors\n", errors);
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,90 @@
+#include "Ender.h"
+#include <string.h>
+
+/* The tags and attributes are matched by their whole name, the unknown ones
+ * that start like a known one are ignored
+ */
+static const char *_description =
+"<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+"<lib name=\"tags\" version=\"0\" case=\"underscore\">\n"
+"  <default name=\"tags.ignored\" type=\"int32\"/>\n"
+"  <def name=\"tags.length\" type=\"int32\" typed=\"double\"/>\n"
+"  <function name=\"tags.f\">\n"
+"    <args name=\"a\" type=\"int32\"/>\n"
+"    <arg name=\"b\" type=\"double\"/>\n"
+"  </function>\n"
+"</lib>\n";
+
+static int _tags(const Ender_Lib *lib)
+{
+	Ender_Item *i;
+	Ender_Item *arg;
+	int errors = 0;
+
+	/* "default" is not "def" */
+	i = ender_lib_item_find(lib, "tags.ignored");
+	if (i)
+	{
+		errors++;
+		ender_item_unref(i);
+	}
+
+	/* "args" is not "arg" */
+	i = ender_lib_item_find(lib, "tags.f");
+	if (!i)
+		return errors + 1;
+	if (ender_item_function_args_count(i) != 1)
+		errors++;
+	arg = ender_item_function_args_at(i, 0);
+	if (!arg || strcmp(ender_item_name_get(arg), "b"))
+		errors++;
+	ender_item_unref(arg);
+	ender_item_unref(i);
+
+	if (errors)
+		printf("Tags failed with %d errors\n", errors);
+	return errors;
+}
+
+static int _attrs(const Ender_Lib *lib)
+{
+	Ender_Item *i;
+	Ender_Item *type;
+	int errors = 0;
+
+	/* "typed" is not "type" */
+	i = ender_lib_item_find(lib, "tags.length");
+	if (!i)
+		return 1;
+	type = ender_item_def_type_get(i);
+	if (!type || strcmp(ender_item_name_get(type), "int32"))
+		errors++;
+	ender_item_unref(type);
+	ender_item_unref(i);
+
+	if (errors)
+		printf("Attributes failed with %d errors\n", errors);
+	return errors;
+}
+
+int main(int argc EINA_UNUSED, char **argv EINA_UNUSED)
+{
+	const Ender_Lib *lib;
+	int errors = 0;
+
+	ender_init();
+	ender_parser_parse_buffer(_description, strlen(_description));
+	lib = ender_lib_find("tags");
+	if (!lib)
+	{
+		printf("Failed to parse the description\n");
+		ender_shutdown();
+		return 1;
+	}
+	errors += _tags(lib);
+	errors += _attrs(lib);
+	ender_shutdown();
+
+	printf("Parser checked with %d errors\n", errors);
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,547 @@
+#include "Ender.h"
+
+/* Several threads look up the libraries and their items while the main thread
+ * keeps parsing new libraries, then loading and unloading other libraries and
+ * finally reloading one. Every library found must be complete
+ */
+#define READERS 8
+#define LIBS 64
+#define CHURNS 256
+
+/* the point is described after the object that refers to it */
+static const char *_description =
+"<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+"<lib name=\"stress%d\" version=\"0\" case=\"underscore\">\n"
+"  <object name=\"stress%d.object\">\n"
+"    <ctor name=\"new\"/>\n"
+"    <prop name=\"a\">\n"
+"      <getter><return type=\"int32\"/></getter>\n"
+"    </prop>\n"
+"    <prop name=\"b\">\n"
+"      <getter><return type=\"double\"/></getter>\n"
+"    </prop>\n"
+"    <method name=\"mix\">\n"
+"      <arg name=\"p\" type=\"stress%d.point\"/>\n"
+"    </method>\n"
+"  </object>\n"
+"  <struct name=\"stress%d.point\">\n"
+"    <field name=\"x\" type=\"int32\"/>\n"
+"    <field name=\"y\" type=\"int32\"/>\n"
+"  </struct>\n"
+"</lib>\n";
+
+/* a lib that depends on the first one */
+static const char *_churn_description =
+"<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+"<lib name=\"churn%d\" version=\"0\" case=\"underscore\">\n"
+"  <include name=\"stress0\"/>\n"
+"  <callback name=\"churn%d.cb\">\n"
+"    <arg name=\"p\" type=\"stress0.point\"/>\n"
+"  </callback>\n"
+"</lib>\n";
+
+/* a lib that changes its struct and def on every version */
+static const char *_reload_description =
+"<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+"<lib name=\"reload\" version=\"0\" case=\"underscore\">\n"
+"  <include name=\"stress0\"/>\n"
+"  <struct name=\"reload.point\">\n"
+"    <field name=\"x%d\" type=\"int32\"/>\n"
+"  </struct>\n"
+"  <def name=\"reload.v%d\" type=\"int32\"/>\n"
+"  <callback name=\"reload.cb\">\n"
+"    <arg name=\"p\" type=\"stress0.point\"/>\n"
+"  </callback>\n"
+"</lib>\n";
+
+/* an object described in two parts and extended by another lib */
+static const char *_reopen_description =
+"<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+"<lib name=\"reopen\" version=\"0\" case=\"underscore\">\n"
+"  <include name=\"stress0\"/>\n"
+"  <object name=\"reopen.object\">\n"
+"    <method name=\"a\"/>\n"
+"  </object>\n"
+"  <object name=\"reopen.object\">\n"
+"    <method name=\"b\"/>\n"
+"  </object>\n"
+"</lib>\n";
+
+static const char *_extend_description =
+"<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+"<lib name=\"extend\" version=\"0\" case=\"underscore\">\n"
+"  <include name=\"reopen\"/>\n"
+"  <object name=\"reopen.object\">\n"
+"    <method name=\"c\"/>\n"
+"  </object>\n"
+"</lib>\n";
+
+/* a lib that depends on the reloaded one */
+static const char *_reload_user_description =
+"<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+"<lib name=\"reload_user\" version=\"0\" case=\"underscore\">\n"
+"  <include name=\"reload\"/>\n"
+"</lib>\n";
+
+/* a lib that includes a churn one, streamed in two parts */
+static const char *_pin_description =
+"<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+"<lib name=\"pin\" version=\"0\" case=\"underscore\">\n"
+"  <include name=\"churn%d\"/>\n"
+"  <def name=\"pin.point\" type=\"stress0.point\"/>\n"
+"</lib>\n";
+
+/* the description of data/ender.ender, the ref and unref have no name */
+static const char *_ender_description =
+"<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+"<lib name=\"ender\" version=\"1\" case=\"underscore\">\n"
+"  <include name=\"eina\"/>\n"
+"  <object name=\"ender.item\">\n"
+"    <ref/>\n"
+"    <unref/>\n"
+"  </object>\n"
+"</lib>\n";
+
+static Ender_Lib_Image _reload_image;
+static int _loaded = 0;
+static int _done = 0;
+static int _reloaded = 0;
+static int _errors = 0;
+
+static int _lib_check(const Ender_Lib *lib, int n)
+{
+	Ender_Item *object;
+	Ender_Item *i;
+	Eina_List *items;
+	char name[64];
+	int errors = 0;
+
+	snprintf(name, sizeof(name), "stress%d.object", n);
+	object = ender_lib_item_find(lib, name);
+	if (!object)
+		return 1;
+
+	items = ender_item_object_props_get(object);
+	if (eina_list_count(items) != 2)
+		errors++;
+	EINA_LIST_FREE(items, i)
+		ender_item_unref(i);
+
+	items = ender_item_object_functions_get(object);
+	EINA_LIST_FREE(items, i)
+	{
+		/* the synthetic self arg is shared by all the threads */
+		if (ender_item_function_flags_get(i) &
+				ENDER_ITEM_FUNCTION_FLAG_IS_METHOD)
+		{
+			Ender_Item *arg;
+
+			arg = ender_item_function_args_at(i, 0);
+			if (!arg)
+				errors++;
+			ender_item_unref(arg);
+
+			/* the point is resolved although it is described later */
+			arg = ender_item_function_args_at(i, 1);
+			if (arg)
+			{
+				Ender_Item *type;
+
+				type = ender_item_arg_type_get(arg);
+				if (!type || ender_item_type_get(type) !=
+						ENDER_ITEM_TYPE_STRUCT)
+					errors++;
+				ender_item_unref(type);
+				ender_item_unref(arg);
+			}
+			else
+			{
+				errors++;
+			}
+		}
+		ender_item_unref(i);
+	}
+	ender_item_unref(object);
+
+	items = ender_lib_item_list(lib, ENDER_ITEM_TYPE_STRUCT);
+	if (eina_list_count(items) != 1)
+		errors++;
+	EINA_LIST_FREE(items, i)
+		ender_item_unref(i);
+
+	return errors;
+}
+
+static void * _reader_cb(void *data EINA_UNUSED, Eina_Thread t EINA_UNUSED)
+{
+	unsigned long long lookups = 0;
+	int errors = 0;
+
+	while (!__atomic_load_n(&_done, __ATOMIC_ACQUIRE))
+	{
+		int loaded;
+		int n;
+
+		loaded = __atomic_load_n(&_loaded, __ATOMIC_ACQUIRE);
+		for (n = 0; n < LIBS; n++)
+		{
+			const Ender_Lib *lib;
+			char name[64];
+
+			snprintf(name, sizeof(name), "stress%d", n);
+			lib = ender_lib_find(name);
+			lookups++;
+			/* a registered lib must never disappear */
+			if (!lib)
+			{
+				if (n < loaded)
+					errors++;
+				continue;
+			}
+			errors += _lib_check(lib, n);
+		}
+	}
+	if (errors)
+		printf("Reader failed with %d errors on %llu lookups\n",
+				errors, lookups);
+	__atomic_add_fetch(&_errors, errors, __ATOMIC_ACQ_REL);
+	return NULL;
+}
+
+static void _description_parse(const char *description, int n)
+{
+	Ender_Parser_Stream *s;
+	char *buf;
+	int len;
+	int i;
+
+	len = snprintf(NULL, 0, description, n, n, n, n);
+	buf = malloc(len + 1);
+	snprintf(buf, len + 1, description, n, n, n, n);
+	/* half of the libs arrive in small chunks */
+	if (n % 2)
+	{
+		s = ender_parser_stream_new();
+		for (i = 0; i < len; i += 7)
+			ender_parser_stream_feed(s, buf + i, len - i < 7 ? len - i : 7);
+		ender_parser_stream_end(s);
+	}
+	else
+	{
+		ender_parser_parse_buffer(buf, len);
+	}
+	free(buf);
+}
+
+/* An incomplete description is not registered */
+static int _incomplete(void)
+{
+	Ender_Parser_Stream *s;
+	char *buf;
+	int len;
+	int errors = 0;
+
+	len = snprintf(NULL, 0, _description, LIBS, LIBS, LIBS, LIBS);
+	buf = malloc(len + 1);
+	snprintf(buf, len + 1, _description, LIBS, LIBS, LIBS, LIBS);
+	s = ender_parser_stream_new();
+	ender_parser_stream_feed(s, buf, len / 2);
+	if (ender_parser_stream_end(s))
+		errors++;
+	snprintf(buf, len, "stress%d", LIBS);
+	if (ender_lib_find(buf))
+		errors++;
+	free(buf);
+	return errors;
+}
+
+/* The functions without a name get a default one */
+static int _nameless(void)
+{
+	const Ender_Lib *lib;
+	Ender_Item *object;
+	Ender_Item *f;
+	Eina_List *items;
+	char *sym;
+	int found = 0;
+	int errors = 0;
+
+	_description_parse(_ender_description, 0);
+	lib = ender_lib_find("ender");
+	if (!lib)
+		return 1;
+	items = ender_lib_dependencies_get(lib);
+	if (eina_list_count(items) != 1)
+		errors++;
+	eina_list_free(items);
+
+	object = ender_lib_item_find(lib, "ender.item");
+	if (!object)
+		return errors + 1;
+	items = ender_item_object_functions_get(object);
+	EINA_LIST_FREE(items, f)
+	{
+		const char *name = ender_item_name_get(f);
+
+		if (!name || (strcmp(name, "ref") && strcmp(name, "unref")))
+			errors++;
+		ender_item_unref(f);
+	}
+	ender_item_unref(object);
+
+	items = ender_lib_symbols_get(lib);
+	EINA_LIST_FREE(items, sym)
+	{
+		if (!strcmp(sym, "ender_item_ref") || !strcmp(sym, "ender_item_unref"))
+			found++;
+		free(sym);
+	}
+	if (found != 2)
+		errors++;
+	return errors;
+}
+
+/* A lib can not be unloaded while in use */
+static int _churn(int n)
+{
+	const Ender_Lib *lib;
+	Ender_Closure *closure;
+	Ender_Item *cb;
+	char name[64];
+	int errors = 0;
+
+	_description_parse(_churn_description, n);
+	snprintf(name, sizeof(name), "churn%d", n);
+	lib = ender_lib_find(name);
+	if (!lib)
+		return 1;
+	if (ender_lib_unload("stress0"))
+		errors++;
+
+	snprintf(name, sizeof(name), "churn%d.cb", n);
+	cb = ender_lib_item_find(lib, name);
+	closure = ender_item_function_closure_new(cb, NULL, NULL);
+	if (!closure)
+		errors++;
+	snprintf(name, sizeof(name), "churn%d", n);
+	if (ender_lib_unload(name))
+		errors++;
+	ender_closure_free(closure);
+	ender_item_unref(cb);
+
+	if (!ender_lib_unload(name))
+		errors++;
+	if (ender_lib_find(name))
+		errors++;
+	return errors;
+}
+
+/* The libs included by a stream parse can not be unloaded between chunks */
+static int _pinned(int n)
+{
+	Ender_Parser_Stream *s;
+	char name[64];
+	char *buf;
+	int len;
+	int errors = 0;
+
+	_description_parse(_churn_description, n);
+	len = snprintf(NULL, 0, _pin_description, n);
+	buf = malloc(len + 1);
+	snprintf(buf, len + 1, _pin_description, n);
+	s = ender_parser_stream_new();
+	/* everything but the closing tag */
+	ender_parser_stream_feed(s, buf, len - 7);
+	snprintf(name, sizeof(name), "churn%d", n);
+	if (ender_lib_unload(name))
+		errors++;
+	ender_parser_stream_feed(s, buf + len - 7, 7);
+	if (!ender_parser_stream_end(s))
+		errors++;
+	free(buf);
+
+	if (!ender_lib_unload("pin"))
+		errors++;
+	if (!ender_lib_unload(name))
+		errors++;
+	return errors;
+}
+
+/* The items of a lib are looked up while it is reloaded */
+static void * _reload_reader_cb(void *data, Eina_Thread t EINA_UNUSED)
+{
+	const Ender_Lib *lib = data;
+	const Ender_Lib *user;
+	int errors = 0;
+
+	user = ender_lib_find("reload_user");
+	while (!__atomic_load_n(&_reloaded, __ATOMIC_ACQUIRE))
+	{
+		Ender_Item *i;
+		Eina_List *items;
+
+		i = ender_lib_item_find(lib, "reload.cb");
+		if (!i)
+			errors++;
+		ender_item_unref(i);
+		i = ender_lib_item_find(lib, "reload.point");
+		if (!i)
+			errors++;
+		ender_item_unref(i);
+		i = ender_lib_item_find(user, "reload.point");
+		if (!i)
+			errors++;
+		ender_item_unref(i);
+		items = ender_lib_dependencies_get(lib);
+		if (eina_list_count(items) != 1)
+			errors++;
+		eina_list_free(items);
+		items = ender_lib_item_list(lib, ENDER_ITEM_TYPE_STRUCT);
+		if (eina_list_count(items) != 1)
+			errors++;
+		EINA_LIST_FREE(items, i)
+			ender_item_unref(i);
+	}
+	if (errors)
+		printf("Reload reader failed with %d errors\n", errors);
+	__atomic_add_fetch(&_errors, errors, __ATOMIC_ACQ_REL);
+	return NULL;
+}
+/* A reopened object is owned once, by the lib that created it */
+static int _reopen(void)
+{
+	const Ender_Lib *lib;
+	Ender_Item *object;
+	Ender_Item *f;
+	Eina_List *functions;
+	int errors = 0;
+
+	_description_parse(_reopen_description, 0);
+	_description_parse(_extend_description, 0);
+	lib = ender_lib_find("extend");
+	if (!lib)
+		return 1;
+	object = ender_lib_item_find(lib, "reopen.object");
+	if (!object)
+		return 1;
+	if (ender_item_lib_get(object) != ender_lib_find("reopen"))
+		errors++;
+	functions = ender_item_object_functions_get(object);
+	if (eina_list_count(functions) != 3)
+		errors++;
+	EINA_LIST_FREE(functions, f)
+		ender_item_unref(f);
+	ender_item_unref(object);
+	/* the extended objects keep the functions of the lib */
+	if (ender_lib_unload("extend"))
+		errors++;
+	if (ender_lib_unload("reopen"))
+		errors++;
+	return errors;
+}
+
+/* A reloaded lib keeps the items that have not changed */
+static int _reload(void)
+{
+	const Ender_Lib *lib;
+	const Ender_Lib *user;
+	Eina_Thread readers[READERS];
+	Ender_Item *point;
+	Ender_Item *cb;
+	Ender_Item *field;
+	Eina_List *fields;
+	size_t size;
+	int errors = 0;
+	int n;
+
+	/* the new version is added as an image */
+	_description_parse(_reload_description, 1);
+	lib = ender_lib_find("reload");
+	if (!lib)
+		return 1;
+	_reload_image.data = ender_lib_image_new(lib, &size);
+	_reload_image.size = size;
+	if (!ender_lib_unload("reload"))
+		return 1;
+
+	_description_parse(_reload_description, 0);
+	_description_parse(_reload_user_description, 0);
+	lib = ender_lib_find("reload");
+	user = ender_lib_find("reload_user");
+	if (!lib || !user)
+		return 1;
+	point = ender_lib_item_find(lib, "reload.point");
+	cb = ender_lib_item_find(lib, "reload.cb");
+	for (n = 0; n < READERS; n++)
+		eina_thread_create(&readers[n], EINA_THREAD_NORMAL, -1,
+				_reload_reader_cb, lib);
+	if (!ender_lib_image_add(&_reload_image))
+		errors++;
+	if (!ender_lib_reload("reload"))
+		errors++;
+	__atomic_store_n(&_reloaded, 1, __ATOMIC_RELEASE);
+	for (n = 0; n < READERS; n++)
+		eina_thread_join(readers[n]);
+	if (ender_lib_find("reload") != lib)
+		errors++;
+	if (ender_lib_item_find(lib, "reload.cb") != cb)
+		errors++;
+	if (ender_lib_item_find(lib, "reload.point") == point)
+		errors++;
+	/* the libs that depend on it find the new items */
+	if (ender_lib_item_find(user, "reload.point") !=
+			ender_lib_item_find(lib, "reload.point"))
+		errors++;
+	if (!ender_lib_item_find(user, "reload.v1"))
+		errors++;
+
+	point = ender_lib_item_find(lib, "reload.point");
+	fields = ender_item_struct_fields_get(point);
+	field = eina_list_data_get(fields);
+	if (!field || strcmp(ender_item_name_get(field), "x1"))
+		errors++;
+	EINA_LIST_FREE(fields, field)
+		ender_item_unref(field);
+	return errors;
+}
+
+int main(int argc EINA_UNUSED, char **argv EINA_UNUSED)
+{
+	Eina_Thread readers[READERS];
+	int n;
+
+	ender_init();
+	for (n = 0; n < READERS; n++)
+	{
+		if (!eina_thread_create(&readers[n], EINA_THREAD_NORMAL, -1,
+				_reader_cb, NULL))
+		{
+			printf("Impossible to create the reader threads\n");
+			return 1;
+		}
+	}
+
+	for (n = 0; n < LIBS; n++)
+	{
+		_description_parse(_description, n);
+		__atomic_store_n(&_loaded, n + 1, __ATOMIC_RELEASE);
+	}
+	__atomic_add_fetch(&_errors, _incomplete(), __ATOMIC_ACQ_REL);
+	__atomic_add_fetch(&_errors, _nameless(), __ATOMIC_ACQ_REL);
+	/* the lookups must not be affected by the unloaded libs */
+	for (n = 0; n < CHURNS; n++)
+		__atomic_add_fetch(&_errors, _churn(n % 4), __ATOMIC_ACQ_REL);
+	__atomic_add_fetch(&_errors, _pinned(4), __ATOMIC_ACQ_REL);
+	__atomic_add_fetch(&_errors, _reopen(), __ATOMIC_ACQ_REL);
+	__atomic_add_fetch(&_errors, _reload(), __ATOMIC_ACQ_REL);
+	__atomic_store_n(&_done, 1, __ATOMIC_RELEASE);
+
+	for (n = 0; n < READERS; n++)
+		eina_thread_join(readers[n]);
+	ender_shutdown();
+	free((void *)_reload_image.data);
+
+	printf("%d libs loaded, %d unloaded and 1 reloaded with %d readers, "
+			"%d errors\n", LIBS, CHURNS, READERS, _errors);
+	return _errors ? 1 : 0;
+}